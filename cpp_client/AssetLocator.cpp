@@ -0,0 +1,46 @@
+#include "AssetLocator.h"
+#include <fstream>
+#include <utility>
+
+#include "LabelUtils.h"
+
+AssetLocator::AssetLocator(std::string override_dir, std::string fallback_dir)
+    : override_dir_(std::move(override_dir)), fallback_dir_(std::move(fallback_dir)) {}
+
+std::string AssetLocator::override_path(const std::string& name) const {
+    if (override_dir_.empty()) return std::string();
+    std::string path = override_dir_ + "/" + name;
+    return std::ifstream(path).good() ? path : std::string();
+}
+
+// Override directory, then the embedded copy, then the fallback directory
+Asset AssetLocator::find(const std::string& name) const {
+    Asset asset;
+    asset.name = name;
+    asset.path = override_path(name);
+    if (!asset.path.empty()) return asset;
+    for (const EmbeddedFile* file = kEmbeddedFiles; file->name; ++file) {
+        if (name == file->name) {
+            asset.data = file->data;
+            asset.size = file->size;
+            return asset;
+        }
+    }
+    asset.path = fallback_dir_ + "/" + name;
+    return asset;
+}
+
+std::shared_ptr<const TextPreprocessor> AssetLocator::preprocessor(int max_len) const {
+    std::string path = override_path("word_index.txt");
+    if (!path.empty()) return std::make_shared<TextPreprocessor>(path, max_len);
+    if (kEmbeddedVocabulary) return std::make_shared<TextPreprocessor>(*kEmbeddedVocabulary, max_len);
+    return nullptr;
+}
+
+std::vector<std::string> AssetLocator::labels() const {
+    std::string path = override_path("labels.txt");
+    if (!path.empty()) return load_labels(path);
+    std::vector<std::string> labels;
+    for (const char* const* label = kEmbeddedLabels; *label; ++label) labels.push_back(*label);
+    return labels;
+}
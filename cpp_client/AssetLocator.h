@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "StaticVocabulary.h"
+#include "TextPreprocessor.h"
+
+// A file built into gui_main by embed_assets
+struct EmbeddedFile {
+    const char* name;
+    const unsigned char* data;
+    size_t size;
+};
+
+// Generated at build time (EmbeddedAssetData.cpp); the lists end with a null entry
+extern const EmbeddedFile kEmbeddedFiles[];
+extern const char* const kEmbeddedLabels[];
+extern const StaticVocabulary* const kEmbeddedVocabulary; // null if word_index.txt was not embedded
+
+// Where one asset comes from: bytes inside the executable, or else a file to read
+struct Asset {
+    std::string name;
+    std::string path;                    // set when the asset is read from disk
+    const unsigned char* data = nullptr; // set when it is embedded
+    size_t size = 0;
+};
+
+// Resolves the GUI's assets. A file in the override directory wins over the embedded
+// copy, so images or a vocabulary can be swapped during development without
+// rebuilding; anything that was not embedded is read from the fallback directory.
+class AssetLocator {
+public:
+    AssetLocator(std::string override_dir, std::string fallback_dir);
+
+    Asset find(const std::string& name) const;
+
+    // word_index.txt from the override directory or the embedded table; null if neither
+    // exists, leaving the classifier to read the model directory's own file
+    std::shared_ptr<const TextPreprocessor> preprocessor(int max_len) const;
+
+    // labels.txt from the override directory or the embedded list; empty if neither exists
+    std::vector<std::string> labels() const;
+
+private:
+    std::string override_dir_;
+    std::string fallback_dir_;
+
+    // Path of name in the override directory, or empty if it is not there
+    std::string override_path(const std::string& name) const;
+};
@@ -0,0 +1,157 @@
+#include "BatchCheckpoint.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+
+namespace {
+
+bool write_all(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t n = ::write(fd, data, size);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        data += n;
+        size -= (size_t)n;
+    }
+    return true;
+}
+
+// Make a rename or an append in dir survive a power loss
+void sync_dir(const std::string& dir) {
+    int fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) return;
+    fsync(fd);
+    close(fd);
+}
+
+} // namespace
+
+bool write_file_atomic(const std::string& path, const std::string& data) {
+    std::string tmp = path + ".tmp";
+    int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) return false;
+    bool ok = write_all(fd, data.data(), data.size()) && fsync(fd) == 0;
+    ok = close(fd) == 0 && ok;
+    if (!ok || std::rename(tmp.c_str(), path.c_str()) != 0) {
+        std::remove(tmp.c_str());
+        return false;
+    }
+    std::string dir = std::filesystem::path(path).parent_path().string();
+    sync_dir(dir.empty() ? "." : dir);
+    return true;
+}
+
+BatchCheckpoint::BatchCheckpoint(std::string dir) : dir_(std::move(dir)) {}
+
+BatchCheckpoint::~BatchCheckpoint() {
+    if (lock_fd_ >= 0) close(lock_fd_);
+}
+
+std::string BatchCheckpoint::chunk_path(uint64_t id) const {
+    char name[32];
+    snprintf(name, sizeof(name), "/chunk-%08llu.tsv", (unsigned long long)id);
+    return dir_ + name;
+}
+
+bool BatchCheckpoint::open(const std::string& header, bool restart) {
+    std::error_code error;
+    std::filesystem::create_directories(dir_, error);
+    if (error) {
+        std::cerr << "ERROR: cannot create " << dir_ << ": " << error.message() << std::endl;
+        return false;
+    }
+    // Two runs writing the same chunk files would overwrite each other's temporaries
+    if (lock_fd_ < 0) {
+        lock_fd_ = ::open((dir_ + "/lock").c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (lock_fd_ < 0 || flock(lock_fd_, LOCK_EX | LOCK_NB) != 0) {
+            std::cerr << "ERROR: " << dir_ << " is in use by another emotion_batch" << std::endl;
+            if (lock_fd_ >= 0) close(lock_fd_);
+            lock_fd_ = -1;
+            return false;
+        }
+    }
+    chunks_.clear();
+
+    std::ifstream in(manifest_path(), std::ios::binary);
+    std::string manifest((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    if (!manifest.empty() && !restart) {
+        if (manifest.compare(0, header.size(), header) != 0) {
+            std::cerr << "ERROR: " << dir_ << " holds the checkpoint of a different input, model or chunk size;"
+                      << " pass --restart to discard it" << std::endl;
+            return false;
+        }
+        // One "chunk" line per finished chunk; a line cut short by a crash is ignored
+        std::istringstream lines(manifest.substr(header.size()));
+        std::string line;
+        while (std::getline(lines, line) && !lines.eof()) {
+            std::istringstream fields(line);
+            std::string tag;
+            Chunk chunk;
+            if (!(fields >> tag >> chunk.id >> chunk.begin >> chunk.end >> chunk.lines) || tag != "chunk" ||
+                chunk.id != chunks_.size() || chunk.begin != resume_offset())
+                break;
+            chunks_.push_back(chunk);
+        }
+    }
+
+    // Rewrite the manifest so it holds exactly the chunks accepted above
+    std::string rewritten = header;
+    for (const Chunk& chunk : chunks_)
+        rewritten += "chunk " + std::to_string(chunk.id) + " " + std::to_string(chunk.begin) + " " +
+                     std::to_string(chunk.end) + " " + std::to_string(chunk.lines) + "\n";
+    if (!write_file_atomic(manifest_path(), rewritten)) {
+        std::cerr << "ERROR: cannot write " << manifest_path() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool BatchCheckpoint::commit(const Chunk& chunk, const std::string& output) {
+    if (!write_file_atomic(chunk_path(chunk.id), output)) {
+        std::cerr << "ERROR: cannot write " << chunk_path(chunk.id) << std::endl;
+        return false;
+    }
+    std::string line = "chunk " + std::to_string(chunk.id) + " " + std::to_string(chunk.begin) + " " +
+                       std::to_string(chunk.end) + " " + std::to_string(chunk.lines) + "\n";
+    int fd = ::open(manifest_path().c_str(), O_WRONLY | O_APPEND | O_CLOEXEC);
+    bool ok = fd >= 0 && write_all(fd, line.data(), line.size()) && fsync(fd) == 0;
+    if (fd >= 0) close(fd);
+    if (!ok) {
+        std::cerr << "ERROR: cannot update " << manifest_path() << std::endl;
+        return false;
+    }
+    chunks_.push_back(chunk);
+    return true;
+}
+
+bool BatchCheckpoint::assemble(std::ostream& out) const {
+    for (const Chunk& chunk : chunks_) {
+        std::ifstream in(chunk_path(chunk.id), std::ios::binary);
+        if (!in) {
+            std::cerr << "ERROR: missing " << chunk_path(chunk.id) << std::endl;
+            return false;
+        }
+        // A chunk of blank lines has no output, and inserting an empty streambuf fails out
+        if (in.peek() != std::ifstream::traits_type::eof()) out << in.rdbuf();
+    }
+    return static_cast<bool>(out.flush());
+}
+
+void BatchCheckpoint::remove() const {
+    // Also the chunks of a run that was restarted with a larger chunk size
+    std::error_code error;
+    for (std::filesystem::directory_iterator it(dir_, error), end; !error && it != end; it.increment(error))
+        if (it->path().filename().string().compare(0, 6, "chunk-") == 0) std::filesystem::remove(it->path(), error);
+    std::remove(manifest_path().c_str());
+    std::remove((dir_ + "/lock").c_str()); // still held, so no other run can start on it meanwhile
+    std::filesystem::remove(dir_, error); // only if nothing else is in it
+}
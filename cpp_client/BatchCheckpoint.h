@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Progress of a long emotion_batch run, kept in a directory so a restarted run continues
+// after the last finished chunk. Every chunk's output is its own file, written to a
+// temporary name, synced and renamed into place; only then is the chunk appended to
+// the manifest. A crash therefore loses at most the chunk in progress, and a chunk that
+// is redone replaces its file instead of adding a second copy.
+//
+// The manifest starts with a header describing the job (input, model fingerprint, chunk
+// size). A directory whose header differs belongs to another job and is not resumed.
+class BatchCheckpoint {
+public:
+    struct Chunk {
+        uint64_t id = 0;
+        uint64_t begin = 0; // input byte range [begin, end)
+        uint64_t end = 0;
+        uint64_t lines = 0; // result lines written
+    };
+
+    explicit BatchCheckpoint(std::string dir);
+    ~BatchCheckpoint();
+
+    BatchCheckpoint(const BatchCheckpoint&) = delete;
+    BatchCheckpoint& operator=(const BatchCheckpoint&) = delete;
+
+    // Load the manifest for the job described by header, or start a new one if there is
+    // none (or restart is set). False, with a message, if the directory holds another job
+    // or another process is using it.
+    bool open(const std::string& header, bool restart);
+
+    // Chunks finished so far, in order, and where the next one starts
+    const std::vector<Chunk>& chunks() const { return chunks_; }
+    uint64_t resume_offset() const { return chunks_.empty() ? 0 : chunks_.back().end; }
+    uint64_t next_id() const { return chunks_.size(); }
+
+    // Store the output of the next chunk and record it as finished
+    bool commit(const Chunk& chunk, const std::string& output);
+
+    // Write the outputs of all chunks, in order, to out
+    bool assemble(std::ostream& out) const;
+
+    // Delete the chunk files and the manifest once the job's output is complete
+    void remove() const;
+
+private:
+    std::string dir_;
+    std::vector<Chunk> chunks_;
+    int lock_fd_ = -1; // flock on DIR/lock for as long as this object lives
+
+    std::string manifest_path() const { return dir_ + "/manifest"; }
+    std::string chunk_path(uint64_t id) const;
+};
+
+// Write data to path through a synced temporary file and a rename, so path holds either
+// its old contents or all of data
+bool write_file_atomic(const std::string& path, const std::string& data);
@@ -0,0 +1,276 @@
+#include "BatchIO.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+const size_t kAlignment = 4096; // O_DIRECT needs page-aligned buffers, offsets and sizes
+
+char* allocate_aligned(size_t size) {
+    void* p = nullptr;
+    if (posix_memalign(&p, kAlignment, size) != 0) throw std::bad_alloc();
+    return static_cast<char*>(p);
+}
+
+} // namespace
+
+LineReader::LineReader(const std::string& path, IoBackend backend, size_t block_size, unsigned depth)
+    : block_size_((block_size + kAlignment - 1) / kAlignment * kAlignment), slots_(std::max(1u, depth)) {
+    fd_ = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    struct stat st;
+    if (fd_ < 0 || fstat(fd_, &st) != 0 || !S_ISREG(st.st_mode)) {
+        std::cerr << "ERROR: cannot read " << path << " as a regular file" << std::endl;
+        failed_ = true;
+        return;
+    }
+    size_ = (uint64_t)st.st_size;
+#ifdef O_DIRECT
+    if (size_ >= kDirectMinSize) {
+        int direct = ::open(path.c_str(), O_RDONLY | O_CLOEXEC | O_DIRECT);
+        if (direct >= 0) { // some file systems (tmpfs) refuse O_DIRECT
+            close(fd_);
+            fd_ = direct;
+        }
+    }
+#endif
+
+    std::vector<IoBuffer> buffers;
+    for (Slot& slot : slots_) {
+        slot.buffer = allocate_aligned(kCarry + block_size_);
+        buffers.push_back({slot.buffer + kCarry, block_size_});
+    }
+    queue_ = make_io_queue((unsigned)slots_.size(), buffers, backend);
+    if (!queue_) return;
+    for (size_t i = 0; i < slots_.size() && next_offset_ < size_; ++i) submit((int)i);
+}
+
+LineReader::~LineReader() {
+    // Reads still in flight write into the buffers; let them land first
+    IoCompletion completion;
+    while (queue_ && queue_->wait(completion)) {}
+    queue_.reset();
+    for (Slot& slot : slots_) free(slot.buffer);
+    if (fd_ >= 0) close(fd_);
+}
+
+// Read the next block of the file into slot
+void LineReader::submit(int slot) {
+    Slot& s = slots_[slot];
+    s.offset = next_offset_;
+    s.expected = (size_t)std::min<uint64_t>(block_size_, size_ - next_offset_);
+    s.filled = 0;
+    s.pending = true;
+    next_offset_ += block_size_;
+
+    IoRequest request;
+    request.fd = fd_;
+    request.data = s.buffer + kCarry;
+    request.size = (uint32_t)block_size_; // whole blocks, as O_DIRECT wants; the last read comes back short
+    request.offset = s.offset;
+    request.buffer = slot;
+    request.tag = (uint64_t)slot;
+    if (!queue_->submit(request)) failed_ = true;
+}
+
+// Record a finished read, asking for the rest of the block if it came back short
+bool LineReader::complete(const IoCompletion& completion) {
+    Slot& s = slots_[completion.tag];
+    if (completion.result < 0) {
+        std::cerr << "ERROR: read failed: " << std::strerror((int)-completion.result) << std::endl;
+        return false;
+    }
+    s.filled += (size_t)completion.result;
+    if (completion.result == 0 || s.filled >= s.expected) { // 0: the file shrank since it was opened
+        s.expected = std::min(s.filled, s.expected);
+        s.pending = false;
+        return true;
+    }
+    IoRequest request;
+    request.fd = fd_;
+    request.data = s.buffer + kCarry + s.filled;
+    request.size = (uint32_t)(s.expected - s.filled);
+    request.offset = s.offset + s.filled;
+    request.buffer = (int)completion.tag;
+    request.tag = completion.tag;
+    return queue_->submit(request);
+}
+
+bool LineReader::next(std::vector<std::string_view>& lines) {
+    lines.clear();
+    if (!queue_ || failed_ || done_) return false;
+
+    // The caller is done with the previous block: read ahead into its buffer
+    if (handed_out_ >= 0 && next_offset_ < size_) submit(handed_out_);
+    handed_out_ = -1;
+    if (block_ * block_size_ >= size_) {
+        done_ = true;
+        return false;
+    }
+
+    int slot = (int)(block_ % slots_.size());
+    Slot& s = slots_[slot];
+    while (s.pending && !failed_) {
+        IoCompletion completion;
+        if (!queue_->wait(completion) || !complete(completion)) failed_ = true;
+    }
+    if (failed_) return false;
+
+    auto push = [&lines](const char* begin, const char* end) {
+        if (end > begin && end[-1] == '\r') --end;
+        lines.emplace_back(begin, (size_t)(end - begin));
+    };
+    char* data = s.buffer + kCarry;
+    const char* p = data;
+    const char* end = data + s.expected;
+    bool last = s.offset + block_size_ >= size_ || s.expected < block_size_; // short: the file shrank
+
+    if (!carry_.empty()) {
+        if (carry_.size() <= kCarry) {
+            // Put the start of the line in front of the block, where its end follows
+            p = data - carry_.size();
+            std::memcpy(data - carry_.size(), carry_.data(), carry_.size());
+            carry_.clear();
+        } else if (const char* newline = static_cast<const char*>(std::memchr(p, '\n', end - p))) {
+            long_line_.assign(carry_).append(p, newline);
+            carry_.clear();
+            push(long_line_.data(), long_line_.data() + long_line_.size());
+            p = newline + 1;
+        } else {
+            carry_.append(p, end);
+            p = end;
+        }
+    }
+    while (p < end) {
+        const char* newline = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        if (!newline) break;
+        push(p, newline);
+        p = newline + 1;
+    }
+    if (p < end) {
+        if (last) push(p, end); // the final line has no line break
+        else carry_.assign(p, end);
+    } else if (last && !carry_.empty()) {
+        long_line_.swap(carry_);
+        carry_.clear();
+        push(long_line_.data(), long_line_.data() + long_line_.size());
+    }
+
+    ++block_;
+    handed_out_ = slot;
+    done_ = last;
+    return true;
+}
+
+ResultWriter::ResultWriter(int fd, IoBackend backend, size_t buffer_size, unsigned depth)
+    : fd_(fd), buffer_size_(std::max<size_t>(kAlignment, buffer_size)), slots_(std::max(1u, depth)) {
+    struct stat st;
+    int flags = fcntl(fd_, F_GETFL);
+    off_t position = lseek(fd_, 0, SEEK_CUR);
+    positioned_ = fstat(fd_, &st) == 0 && S_ISREG(st.st_mode) && flags >= 0 && !(flags & O_APPEND) && position >= 0;
+    if (positioned_) offset_ = (uint64_t)position;
+
+    std::vector<IoBuffer> buffers;
+    for (Slot& slot : slots_) {
+        slot.buffer = allocate_aligned(buffer_size_);
+        buffers.push_back({slot.buffer, buffer_size_});
+    }
+    queue_ = make_io_queue((unsigned)slots_.size(), buffers, backend);
+}
+
+ResultWriter::~ResultWriter() {
+    if (queue_) {
+        finish();
+        IoCompletion completion;
+        while (queue_->wait(completion)) {} // after a failure, writes may still be in flight
+    }
+    queue_.reset();
+    for (Slot& slot : slots_) free(slot.buffer);
+}
+
+void ResultWriter::submit(int slot) {
+    Slot& s = slots_[slot];
+    IoRequest request;
+    request.write = true;
+    request.fd = fd_;
+    request.data = s.buffer + s.written;
+    request.size = (uint32_t)(s.size - s.written);
+    request.offset = positioned_ ? s.offset + s.written : IoRequest::kCurrentPosition;
+    request.buffer = slot;
+    request.tag = (uint64_t)slot;
+    if (!queue_->submit(request)) failed_ = true;
+}
+
+// Start writing the current buffer, then make the next free buffer current
+void ResultWriter::submit_current() {
+    if (!queue_) {
+        used_ = 0; // nowhere to write; ok() told the caller
+        return;
+    }
+    Slot& s = slots_[current_];
+    s.size = used_;
+    s.written = 0;
+    s.offset = offset_;
+    s.busy = true;
+    offset_ += used_;
+    ++busy_;
+    submit(current_);
+    used_ = 0;
+
+    // Without explicit offsets, a second write could overtake the first
+    unsigned max_busy = positioned_ ? (unsigned)slots_.size() : 1;
+    while (busy_ >= max_busy && !failed_) {
+        IoCompletion completion;
+        if (!queue_->wait(completion) || !complete(completion)) failed_ = true;
+    }
+    for (size_t i = 0; i < slots_.size(); ++i)
+        if (!slots_[i].busy) {
+            current_ = (int)i;
+            break;
+        }
+}
+
+// Record a finished write, continuing it if it was short
+bool ResultWriter::complete(const IoCompletion& completion) {
+    Slot& s = slots_[completion.tag];
+    if (completion.result <= 0) {
+        std::cerr << "ERROR: write failed: "
+                  << (completion.result < 0 ? std::strerror((int)-completion.result) : "nothing written") << std::endl;
+        return false;
+    }
+    s.written += (size_t)completion.result;
+    if (s.written < s.size) {
+        submit((int)completion.tag);
+        return !failed_;
+    }
+    s.busy = false;
+    --busy_;
+    return true;
+}
+
+void ResultWriter::append_slow(const char* data, size_t size) {
+    while (size > 0) {
+        size_t n = std::min(size, buffer_size_ - used_);
+        std::memcpy(slots_[current_].buffer + used_, data, n);
+        used_ += n;
+        data += n;
+        size -= n;
+        if (used_ == buffer_size_) submit_current();
+    }
+}
+
+bool ResultWriter::finish() {
+    if (!queue_) return false;
+    if (used_ > 0) submit_current();
+    while (busy_ > 0 && !failed_) {
+        IoCompletion completion;
+        if (!queue_->wait(completion) || !complete(completion)) failed_ = true;
+    }
+    // Leave the file position after the output, as sequential writes would have
+    if (positioned_ && !failed_) lseek(fd_, (off_t)offset_, SEEK_SET);
+    return !failed_;
+}
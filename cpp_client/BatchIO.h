@@ -0,0 +1,123 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "IoQueue.h"
+
+// Reads a regular file as lines with several large, page-aligned reads in flight on an
+// IoQueue, so the disk keeps streaming while the caller works on the previous block.
+// Lines are handed out as views into the read buffers; only a line that crosses a block
+// boundary is copied, into the space reserved in front of the next block. Files of
+// kDirectMinSize or more are read with O_DIRECT, bypassing the page cache they would
+// otherwise flush.
+class LineReader {
+public:
+    static constexpr uint64_t kDirectMinSize = 1ULL << 30;
+
+    explicit LineReader(const std::string& path, IoBackend backend = IoBackend::Auto, size_t block_size = 1 << 20,
+                        unsigned depth = 4);
+    ~LineReader();
+
+    LineReader(const LineReader&) = delete;
+    LineReader& operator=(const LineReader&) = delete;
+
+    bool ok() const { return queue_ != nullptr; }
+    const char* backend() const { return queue_ ? queue_->name() : "none"; }
+
+    // Replace lines with the lines completed by the next block, without their line breaks
+    // (or a trailing \r). The views stay valid until the next call. False once the file is
+    // used up, or if a read failed (failed() tells which).
+    bool next(std::vector<std::string_view>& lines);
+    bool failed() const { return failed_; }
+
+private:
+    static constexpr size_t kCarry = 64 * 1024; // room in front of each block for a carried-over line
+
+    struct Slot {
+        char* buffer = nullptr; // kCarry bytes, then the block
+        uint64_t offset = 0;
+        size_t expected = 0;
+        size_t filled = 0;
+        bool pending = false;
+    };
+
+    int fd_ = -1;
+    uint64_t size_ = 0;
+    size_t block_size_;
+    std::vector<Slot> slots_;
+    std::unique_ptr<IoQueue> queue_;
+    uint64_t next_offset_ = 0; // of the next block to read
+    uint64_t block_ = 0;       // index of the next block to hand out
+    int handed_out_ = -1;      // slot whose lines the caller may still be looking at
+    bool done_ = false;
+    bool failed_ = false;
+    std::string carry_;        // start of a line continued in the next block
+    std::string long_line_;    // a line longer than kCarry, put together here
+
+    void submit(int slot);
+    bool complete(const IoCompletion& completion);
+};
+
+// Buffers output and writes it with several writes in flight on an IoQueue, from buffers
+// registered with io_uring. Writes to a regular file go to explicit offsets and may
+// complete in any order; anything else (a pipe, a terminal, an O_APPEND file) is written
+// one buffer at a time at the file position.
+class ResultWriter {
+public:
+    explicit ResultWriter(int fd, IoBackend backend = IoBackend::Auto, size_t buffer_size = 1 << 20,
+                          unsigned depth = 4);
+    ~ResultWriter();
+
+    ResultWriter(const ResultWriter&) = delete;
+    ResultWriter& operator=(const ResultWriter&) = delete;
+
+    bool ok() const { return queue_ != nullptr; }
+    const char* backend() const { return queue_ ? queue_->name() : "none"; }
+
+    void append(const char* data, size_t size) {
+        if (used_ + size <= buffer_size_) {
+            std::memcpy(slots_[current_].buffer + used_, data, size);
+            used_ += size;
+        } else {
+            append_slow(data, size);
+        }
+    }
+    void append(std::string_view text) { append(text.data(), text.size()); }
+    void append(char c) {
+        if (used_ < buffer_size_) slots_[current_].buffer[used_++] = c;
+        else append_slow(&c, 1);
+    }
+
+    // Write out everything appended and wait for it; false if any write failed
+    bool finish();
+
+private:
+    struct Slot {
+        char* buffer = nullptr;
+        size_t size = 0;
+        size_t written = 0;
+        uint64_t offset = 0;
+        bool busy = false;
+    };
+
+    int fd_;
+    bool positioned_ = false; // explicit offsets; otherwise one write at a time
+    uint64_t offset_ = 0;     // where the next buffer goes
+    size_t buffer_size_;
+    std::vector<Slot> slots_;
+    std::unique_ptr<IoQueue> queue_;
+    int current_ = 0;
+    size_t used_ = 0;
+    unsigned busy_ = 0;
+    bool failed_ = false;
+
+    void append_slow(const char* data, size_t size);
+    void submit(int slot);
+    void submit_current();
+    bool complete(const IoCompletion& completion);
+};
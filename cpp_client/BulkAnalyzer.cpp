@@ -0,0 +1,253 @@
+#include "BulkAnalyzer.h"
+#include <chrono>
+#include <fstream>
+#include <iterator>
+
+namespace {
+
+void append_utf8(std::string& out, uint32_t cp) {
+    if (cp < 0x80) {
+        out += (char)cp;
+    } else if (cp < 0x800) {
+        out += (char)(0xC0 | (cp >> 6));
+        out += (char)(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+        out += (char)(0xE0 | (cp >> 12));
+        out += (char)(0x80 | ((cp >> 6) & 0x3F));
+        out += (char)(0x80 | (cp & 0x3F));
+    } else {
+        out += (char)(0xF0 | (cp >> 18));
+        out += (char)(0x80 | ((cp >> 12) & 0x3F));
+        out += (char)(0x80 | ((cp >> 6) & 0x3F));
+        out += (char)(0x80 | (cp & 0x3F));
+    }
+}
+
+bool parse_hex4(const std::string& s, size_t pos, uint32_t& value) {
+    if (pos + 4 > s.size()) return false;
+    value = 0;
+    for (size_t i = pos; i < pos + 4; ++i) {
+        char c = s[i];
+        value <<= 4;
+        if (c >= '0' && c <= '9') value |= (uint32_t)(c - '0');
+        else if (c >= 'a' && c <= 'f') value |= (uint32_t)(c - 'a' + 10);
+        else if (c >= 'A' && c <= 'F') value |= (uint32_t)(c - 'A' + 10);
+        else return false;
+    }
+    return true;
+}
+
+// The "text" string of a one-line JSON object; false if there is none. Not a full JSON
+// parser: it finds the first "text" key and decodes the string value that follows.
+bool json_text_field(const std::string& line, std::string& text) {
+    size_t pos = line.find("\"text\"");
+    if (pos == std::string::npos) return false;
+    pos = line.find_first_not_of(" \t", pos + 6);
+    if (pos == std::string::npos || line[pos] != ':') return false;
+    pos = line.find_first_not_of(" \t", pos + 1);
+    if (pos == std::string::npos || line[pos] != '"') return false;
+
+    text.clear();
+    for (++pos; pos < line.size(); ++pos) {
+        char c = line[pos];
+        if (c == '"') return true;
+        if (c != '\\') {
+            text += c;
+            continue;
+        }
+        if (++pos >= line.size()) return false;
+        switch (line[pos]) {
+        case 'n': text += '\n'; break;
+        case 't': text += '\t'; break;
+        case 'r': text += '\r'; break;
+        case 'b': text += '\b'; break;
+        case 'f': text += '\f'; break;
+        case 'u': {
+            uint32_t cp, low;
+            if (!parse_hex4(line, pos + 1, cp)) return false;
+            pos += 4;
+            // A surrogate pair spells one code point above U+FFFF
+            if (cp >= 0xD800 && cp < 0xDC00 && line.compare(pos + 1, 2, "\\u") == 0 &&
+                parse_hex4(line, pos + 3, low) && low >= 0xDC00 && low < 0xE000) {
+                cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                pos += 6;
+            }
+            append_utf8(text, cp);
+            break;
+        }
+        default: text += line[pos]; break; // \" \\ \/
+        }
+    }
+    return false; // unterminated string
+}
+
+bool has_suffix(const std::string& s, const std::string& suffix) {
+    return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+} // namespace
+
+BulkAnalyzer::BulkAnalyzer(const ClassifierHost& host, int workers, size_t batch_size,
+                           std::function<void()> on_progress)
+    : host_(host), worker_count_(workers > 0 ? workers : 1), batch_size_(batch_size > 0 ? batch_size : 1),
+      on_progress_(std::move(on_progress)) {}
+
+BulkAnalyzer::~BulkAnalyzer() {
+    cancel();
+}
+
+void BulkAnalyzer::start(const std::string& path) {
+    cancel();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.clear();
+        finished_.clear();
+        labels_.clear();
+        progress_ = Progress();
+        progress_.path = path;
+        progress_.running = true;
+        reading_ = true;
+        active_workers_ = worker_count_;
+    }
+    stop_ = false;
+    reader_ = std::thread(&BulkAnalyzer::read_file, this, path);
+    for (int i = 0; i < worker_count_; ++i) workers_.emplace_back(&BulkAnalyzer::classify_batches, this);
+}
+
+void BulkAnalyzer::cancel() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_); // no waiter may miss the wake-up below
+        stop_ = true;
+    }
+    batch_ready_.notify_all();
+    queue_space_.notify_all();
+    join();
+}
+
+void BulkAnalyzer::join() {
+    if (reader_.joinable()) reader_.join();
+    for (std::thread& worker : workers_) worker.join();
+    workers_.clear();
+    std::lock_guard<std::mutex> lock(mutex_);
+    progress_.running = false;
+}
+
+size_t BulkAnalyzer::take_rows(std::vector<BulkRow>& out) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t count = finished_.size();
+    out.insert(out.end(), std::make_move_iterator(finished_.begin()), std::make_move_iterator(finished_.end()));
+    finished_.clear();
+    return count;
+}
+
+BulkAnalyzer::Progress BulkAnalyzer::progress() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return progress_;
+}
+
+void BulkAnalyzer::progress(Progress& out) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    out = progress_;
+}
+
+std::vector<std::string> BulkAnalyzer::labels() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return labels_;
+}
+
+// Wait for room in the queue (at most two batches per worker are read ahead), then hand batch over
+bool BulkAnalyzer::push_batch(Batch& batch) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    queue_space_.wait(lock, [this] { return stop_ || queue_.size() < (size_t)worker_count_ * 2; });
+    if (stop_) return false;
+    progress_.rows_read += batch.texts.size();
+    queue_.push_back(std::move(batch));
+    batch = Batch();
+    batch_ready_.notify_one();
+    return true;
+}
+
+void BulkAnalyzer::read_file(const std::string& path) {
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        progress_.error = "Cannot open " + path;
+    } else {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            progress_.bytes_total = (uint64_t)in.tellg();
+        }
+        in.seekg(0);
+        const bool jsonl = has_suffix(path, ".jsonl") || has_suffix(path, ".json");
+        Batch batch;
+        std::string line, text;
+        uint64_t skipped = 0;
+        uint32_t line_no = 0;
+        while (!stop_ && std::getline(in, line)) {
+            ++line_no;
+            batch.bytes += line.size() + 1;
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            if (line.find_first_not_of(" \t") == std::string::npos) continue;
+            if (jsonl && !json_text_field(line, text)) {
+                ++skipped;
+                continue;
+            }
+            batch.lines.push_back(line_no);
+            batch.texts.push_back(jsonl ? std::move(text) : std::move(line));
+            if (batch.texts.size() == batch_size_ && !push_batch(batch)) break;
+        }
+        if (batch.bytes > 0) push_batch(batch);
+        std::lock_guard<std::mutex> lock(mutex_);
+        progress_.skipped = skipped;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    reading_ = false;
+    batch_ready_.notify_all();
+}
+
+void BulkAnalyzer::classify_batches() {
+    std::vector<PredictionResult> results;
+    for (;;) {
+        Batch batch;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            batch_ready_.wait(lock, [this] { return stop_ || !queue_.empty() || !reading_; });
+            if (stop_ || queue_.empty()) break;
+            batch = std::move(queue_.front());
+            queue_.pop_front();
+            queue_space_.notify_one();
+        }
+
+        // The file may be dropped while the model is still loading
+        std::shared_ptr<const EmotionClassifier> classifier;
+        while (!stop_ && !(classifier = host_.acquire()))
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        if (stop_) break;
+
+        results.assign(batch.texts.size(), PredictionResult());
+        if (!batch.texts.empty()) classifier->predict_texts(batch.texts, results.data());
+        std::vector<BulkRow> rows(batch.texts.size());
+        for (size_t i = 0; i < rows.size(); ++i) {
+            rows[i].line = batch.lines[i];
+            rows[i].class_id = results[i].ok() ? (int8_t)results[i].class_id : (int8_t)-1;
+            rows[i].confidence = results[i].confidence();
+            rows[i].text = std::move(batch.texts[i]);
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (labels_.empty()) labels_ = classifier->labels();
+            finished_.insert(finished_.end(), std::make_move_iterator(rows.begin()), std::make_move_iterator(rows.end()));
+            progress_.rows_done += rows.size();
+            progress_.bytes_done += batch.bytes;
+        }
+        if (on_progress_) on_progress_();
+    }
+
+    bool last = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        last = --active_workers_ == 0;
+        if (last) progress_.running = false;
+    }
+    if (last && on_progress_) on_progress_();
+}
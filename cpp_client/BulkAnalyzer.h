@@ -0,0 +1,94 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ClassifierHost.h"
+
+// One classified line of a bulk file
+struct BulkRow {
+    uint32_t line = 0;     // 1-based line number in the file
+    int8_t class_id = -1;  // -1 if the prediction failed
+    float confidence = 0.0f;
+    std::string text;
+};
+
+// Classifies every line of a text file (or the "text" field of every JSONL record) in
+// the background. A reader thread streams the file into batches and a few worker
+// threads classify them, so the caller only ever collects finished rows.
+class BulkAnalyzer {
+public:
+    struct Progress {
+        std::string path; // empty before the first start()
+        uint64_t bytes_total = 0;
+        uint64_t bytes_done = 0; // bytes whose lines are classified
+        uint64_t rows_read = 0;
+        uint64_t rows_done = 0;
+        uint64_t skipped = 0; // JSONL lines without a "text" string
+        bool running = false;
+        std::string error;
+    };
+
+    // on_progress, if set, is called on a worker thread whenever new rows are ready
+    explicit BulkAnalyzer(const ClassifierHost& host, int workers = 2, size_t batch_size = 128,
+                          std::function<void()> on_progress = nullptr);
+    ~BulkAnalyzer();
+
+    BulkAnalyzer(const BulkAnalyzer&) = delete;
+    BulkAnalyzer& operator=(const BulkAnalyzer&) = delete;
+
+    // Start classifying path, abandoning the current file if there is one
+    void start(const std::string& path);
+
+    // Stop reading and classifying; rows finished so far stay available
+    void cancel();
+
+    // Append the rows finished since the last call to out, in completion order
+    size_t take_rows(std::vector<BulkRow>& out);
+
+    Progress progress() const;
+
+    // Same, copied into out so its strings keep their capacity from frame to frame
+    void progress(Progress& out) const;
+
+    // Labels of the model that classified the rows; empty until the first batch is done
+    std::vector<std::string> labels() const;
+
+private:
+    struct Batch {
+        std::vector<uint32_t> lines;
+        std::vector<std::string> texts;
+        uint64_t bytes = 0;
+    };
+
+    const ClassifierHost& host_;
+    const int worker_count_;
+    const size_t batch_size_;
+    std::function<void()> on_progress_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable batch_ready_;
+    std::condition_variable queue_space_;
+    std::deque<Batch> queue_;
+    bool reading_ = false;
+    int active_workers_ = 0;
+    std::atomic<bool> stop_{false};
+    std::vector<BulkRow> finished_;
+    std::vector<std::string> labels_;
+    Progress progress_;
+
+    std::thread reader_;
+    std::vector<std::thread> workers_;
+
+    void read_file(const std::string& path);
+    void classify_batches();
+    bool push_batch(Batch& batch);
+    void join();
+};
@@ -0,0 +1,134 @@
+#include "BulkResultsView.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include "imgui.h"
+
+void BulkResultsView::reset() {
+    rows_.clear();
+    order_.clear();
+    labels_.clear();
+    counts_.fill(0);
+    failed_ = 0;
+}
+
+// Sort order of the selected column; the line number breaks ties so the order is total
+bool BulkResultsView::before(uint32_t a, uint32_t b) const {
+    const BulkRow& x = rows_[a];
+    const BulkRow& y = rows_[b];
+    int cmp = 0;
+    switch (sort_column_) {
+    case COLUMN_TEXT: cmp = x.text.compare(y.text); break;
+    case COLUMN_EMOTION: cmp = (int)x.class_id - (int)y.class_id; break;
+    case COLUMN_CONFIDENCE: cmp = x.confidence < y.confidence ? -1 : x.confidence > y.confidence ? 1 : 0; break;
+    default: break;
+    }
+    if (cmp == 0) cmp = x.line < y.line ? -1 : x.line > y.line ? 1 : 0;
+    return ascending_ ? cmp < 0 : cmp > 0;
+}
+
+// Take the newly finished rows, count them and merge them into the sorted order
+void BulkResultsView::collect(BulkAnalyzer& analyzer) {
+    const size_t first = rows_.size();
+    if (analyzer.take_rows(rows_) == 0) return;
+    if (labels_.empty()) labels_ = analyzer.labels();
+    for (size_t i = first; i < rows_.size(); ++i) {
+        if (rows_[i].class_id >= 0) ++counts_[rows_[i].class_id];
+        else ++failed_;
+        order_.push_back((uint32_t)i);
+    }
+    auto less = [this](uint32_t a, uint32_t b) { return before(a, b); };
+    auto middle = order_.begin() + (std::ptrdiff_t)first;
+    std::sort(middle, order_.end(), less);
+    std::inplace_merge(order_.begin(), middle, order_.end(), less);
+}
+
+void BulkResultsView::draw(BulkAnalyzer& analyzer) {
+    collect(analyzer);
+    analyzer.progress(progress_);
+    const BulkAnalyzer::Progress& progress = progress_;
+    if (progress.path.empty()) {
+        ImGui::TextDisabled("Drop a .txt or .jsonl file on the window to classify every line.");
+        return;
+    }
+
+    const size_t slash = progress.path.find_last_of("/\\");
+    ImGui::Text("%s", slash == std::string::npos ? progress.path.c_str() : progress.path.c_str() + slash + 1);
+    if (!progress.error.empty()) {
+        ImGui::PushStyleColor(ImGuiCol_Text, IM_COL32(255, 80, 80, 255));
+        ImGui::TextWrapped("%s", progress.error.c_str());
+        ImGui::PopStyleColor();
+        return;
+    }
+
+    char overlay[96];
+    snprintf(overlay, sizeof(overlay), "%llu / %llu lines%s", (unsigned long long)progress.rows_done,
+             (unsigned long long)progress.rows_read, progress.running ? "" : " - done");
+    float fraction = progress.bytes_total ? (float)((double)progress.bytes_done / progress.bytes_total) : 1.0f;
+    ImGui::ProgressBar(progress.running ? fraction : 1.0f, ImVec2(-80.0f, 0), overlay);
+    ImGui::SameLine();
+    ImGui::BeginDisabled(!progress.running);
+    if (ImGui::Button("Stop", ImVec2(-FLT_MIN, 0))) analyzer.cancel();
+    ImGui::EndDisabled();
+
+    for (size_t i = 0; i < labels_.size() && i < counts_.size(); ++i) {
+        if (i > 0) ImGui::SameLine();
+        ImGui::Text("%s %llu", labels_[i].c_str(), (unsigned long long)counts_[i]);
+    }
+    if (failed_) {
+        ImGui::SameLine();
+        ImGui::TextDisabled("failed %llu", (unsigned long long)failed_);
+    }
+    if (progress.skipped) {
+        ImGui::SameLine();
+        ImGui::TextDisabled("no text %llu", (unsigned long long)progress.skipped);
+    }
+    draw_table();
+}
+
+void BulkResultsView::draw_table() {
+    const ImGuiTableFlags flags = ImGuiTableFlags_Sortable | ImGuiTableFlags_ScrollY | ImGuiTableFlags_RowBg |
+                                  ImGuiTableFlags_BordersOuter | ImGuiTableFlags_BordersV | ImGuiTableFlags_Resizable;
+    float height = std::max(ImGui::GetContentRegionAvail().y, ImGui::GetTextLineHeightWithSpacing() * 8);
+    if (!ImGui::BeginTable("##bulk_results", 4, flags, ImVec2(0, height))) return;
+    ImGui::TableSetupScrollFreeze(0, 1);
+    ImGui::TableSetupColumn("#", ImGuiTableColumnFlags_DefaultSort | ImGuiTableColumnFlags_WidthFixed, 0.0f, COLUMN_LINE);
+    ImGui::TableSetupColumn("Text", ImGuiTableColumnFlags_WidthStretch, 0.0f, COLUMN_TEXT);
+    ImGui::TableSetupColumn("Emotion", ImGuiTableColumnFlags_WidthFixed, 0.0f, COLUMN_EMOTION);
+    ImGui::TableSetupColumn("Confidence", ImGuiTableColumnFlags_WidthFixed | ImGuiTableColumnFlags_PreferSortDescending,
+                            0.0f, COLUMN_CONFIDENCE);
+    ImGui::TableHeadersRow();
+
+    if (ImGuiTableSortSpecs* specs = ImGui::TableGetSortSpecs()) {
+        if (specs->SpecsDirty && specs->SpecsCount > 0) {
+            sort_column_ = (int)specs->Specs[0].ColumnUserID;
+            ascending_ = specs->Specs[0].SortDirection != ImGuiSortDirection_Descending;
+            std::sort(order_.begin(), order_.end(), [this](uint32_t a, uint32_t b) { return before(a, b); });
+        }
+        specs->SpecsDirty = false;
+    }
+
+    ImGuiListClipper clipper;
+    clipper.Begin((int)order_.size());
+    while (clipper.Step()) {
+        for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i) {
+            const BulkRow& row = rows_[order_[i]];
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("%u", row.line);
+            ImGui::TableNextColumn();
+            // First line only, so every row keeps the height the clipper assumes
+            const char* text_end = (const char*)std::memchr(row.text.data(), '\n', row.text.size());
+            ImGui::TextUnformatted(row.text.data(), text_end ? text_end : row.text.data() + row.text.size());
+            ImGui::TableNextColumn();
+            if (row.class_id >= 0 && row.class_id < (int)labels_.size())
+                ImGui::TextUnformatted(labels_[row.class_id].c_str());
+            else
+                ImGui::TextDisabled("failed");
+            ImGui::TableNextColumn();
+            ImGui::Text("%.0f%%", 100.0f * row.confidence);
+        }
+    }
+    ImGui::EndTable();
+}
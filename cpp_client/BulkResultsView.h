@@ -0,0 +1,37 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "BulkAnalyzer.h"
+
+// GUI side of bulk mode. Collects the rows a BulkAnalyzer finishes and draws the
+// progress, per-emotion counts and a sortable results table. Only the visible rows are
+// laid out (ImGuiListClipper), and new rows are merged into the current sort order
+// instead of re-sorting everything, so large files scroll at full frame rate.
+class BulkResultsView {
+public:
+    // Forget the rows of the previous file
+    void reset();
+
+    // Draw into the current window; call once per frame on the UI thread
+    void draw(BulkAnalyzer& analyzer);
+
+private:
+    enum Column { COLUMN_LINE, COLUMN_TEXT, COLUMN_EMOTION, COLUMN_CONFIDENCE };
+
+    BulkAnalyzer::Progress progress_;
+    std::vector<BulkRow> rows_;
+    std::vector<uint32_t> order_; // indices into rows_ in display order
+    std::vector<std::string> labels_;
+    std::array<uint64_t, kMaxClasses> counts_{};
+    uint64_t failed_ = 0;
+    int sort_column_ = COLUMN_LINE;
+    bool ascending_ = true;
+
+    bool before(uint32_t a, uint32_t b) const;
+    void collect(BulkAnalyzer& analyzer);
+    void draw_table();
+};
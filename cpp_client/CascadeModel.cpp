@@ -0,0 +1,58 @@
+#include "CascadeModel.h"
+#include "ModelBundle.h"
+#include "ScratchArena.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+bool CascadeModel::load(const std::string& bundle_path) {
+    ModelBundle bundle;
+    if (!bundle.load(bundle_path)) return false;
+
+    const BundleTensor* emb = bundle.find("embedding");
+    const BundleTensor* k1 = bundle.find("dense1_kernel");
+    const BundleTensor* b1 = bundle.find("dense1_bias");
+    const BundleTensor* k2 = bundle.find("dense2_kernel");
+    const BundleTensor* b2 = bundle.find("dense2_bias");
+    const BundleTensor* threshold = bundle.find("threshold");
+    if (!emb || !k1 || !b1 || !k2 || !b2 || !threshold || emb->dims.size() != 2 || k1->dims.size() != 2 ||
+        k2->dims.size() != 2 || k1->dims[0] != emb->dims[1] || k2->dims[0] != k1->dims[1] ||
+        (int)b1->data.size() != k1->dims[1] || (int)b2->data.size() != k2->dims[1] || threshold->data.empty()) {
+        std::cerr << "ERROR: cascade bundle " << bundle_path << " is missing tensors or has the wrong shapes" << std::endl;
+        return false;
+    }
+    vocab_size_ = emb->dims[0];
+    embedding_dim_ = emb->dims[1];
+    embedding_ = emb->data;
+    dense1_ = pack_dense(k1->dims[0], k1->dims[1], k1->data, b1->data);
+    dense2_ = pack_dense(k2->dims[0], k2->dims[1], k2->data, b2->data);
+    threshold_ = threshold->data[0];
+    std::cerr << "[CASCADE] loaded " << bundle_path << ", threshold " << threshold_ << std::endl;
+    return true;
+}
+
+// Mean of the embedding rows of every non-padding token, as in train.py
+bool CascadeModel::classify(const float* tokens, int seq_len, float* probs) const {
+    ScratchArena::Scope scope;
+    ScratchArena& arena = ScratchArena::local();
+    float* mean = arena.zeros(embedding_dim_);
+    int count = 0;
+    for (int t = 0; t < seq_len; ++t) {
+        int id = (int)tokens[t];
+        if (id <= 0 || id >= vocab_size_) continue;
+        const float* row = &embedding_[(size_t)id * embedding_dim_];
+        for (int d = 0; d < embedding_dim_; ++d) mean[d] += row[d];
+        ++count;
+    }
+    if (count == 0) return false; // nothing to go on; let the full model decide
+    for (int d = 0; d < embedding_dim_; ++d) mean[d] /= count;
+
+    float* hidden = arena.floats(dense1_.units);
+    dense_forward(dense1_, mean, hidden, true);
+    dense_forward(dense2_, hidden, probs, false);
+    float max_logit = *std::max_element(probs, probs + dense2_.units);
+    float sum = 0.0f;
+    for (int j = 0; j < dense2_.units; ++j) sum += (probs[j] = std::exp(probs[j] - max_logit));
+    for (int j = 0; j < dense2_.units; ++j) probs[j] /= sum;
+    return *std::max_element(probs, probs + dense2_.units) >= threshold_;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "LstmKernels.h"
+
+// Cheap first stage in front of the full model: the mean GloVe vector of the input's
+// tokens through Dense relu -> Dense softmax. Trained by train.py, which also picks the
+// confidence threshold at which it is as accurate as the BiLSTM on validation data.
+class CascadeModel {
+public:
+    // Load cascade.bundle (embedding, dense1/dense2 kernel and bias, threshold)
+    bool load(const std::string& bundle_path);
+
+    // Write class probabilities for one padded sequence of token ids to probs;
+    // true if the top probability reaches the threshold and the answer can be used
+    bool classify(const float* tokens, int seq_len, float* probs) const;
+
+    int num_classes() const { return dense2_.units; }
+    float threshold() const { return threshold_; }
+    void set_threshold(float threshold) { threshold_ = threshold; }
+
+private:
+    int vocab_size_ = 0;
+    int embedding_dim_ = 0;
+    std::vector<float> embedding_; // [vocab_size, embedding_dim]
+    PackedDense dense1_, dense2_;
+    float threshold_ = 1.0f;
+};
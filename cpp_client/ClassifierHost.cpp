@@ -0,0 +1,145 @@
+#include "ClassifierHost.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+// Accuracy a new model may lose on the canary set relative to the active one
+static const double kCanaryTolerance = 0.05;
+
+ClassifierHost::ClassifierHost(const std::string& model_dir, const ClassifierConfig& config)
+    : model_dir_(model_dir), config_(config) {}
+
+ClassifierHost::~ClassifierHost() {
+    stop_ = true;
+    if (watcher_.joinable()) watcher_.join();
+}
+
+std::shared_ptr<const EmotionClassifier> ClassifierHost::acquire() const {
+    return std::atomic_load(&active_);
+}
+
+// Load and warm a classifier from model_dir without touching the active one
+std::shared_ptr<EmotionClassifier> ClassifierHost::load_candidate(const ClassifierConfig& config) const {
+    auto candidate = std::make_shared<EmotionClassifier>(config);
+    if (!candidate->load(model_dir_) || !candidate->warm_up())
+        return nullptr;
+    return candidate;
+}
+
+bool ClassifierHost::load_initial() {
+    auto candidate = load_candidate(config_);
+    if (!candidate) return false;
+    std::atomic_store(&active_, std::shared_ptr<const EmotionClassifier>(candidate));
+    return true;
+}
+
+// Score a classifier on canary.txt ("text;label" per line, same format as the training data)
+static double canary_accuracy(const EmotionClassifier& classifier, const std::string& canary_path, size_t& count) {
+    std::ifstream infile(canary_path);
+    std::string line;
+    size_t correct = 0;
+    count = 0;
+    while (std::getline(infile, line)) {
+        size_t sep = line.rfind(';');
+        if (sep == std::string::npos) continue;
+        ++count;
+        if (classifier.classify(line.substr(0, sep)) == line.substr(sep + 1)) ++correct;
+    }
+    return count ? (double)correct / count : 0.0;
+}
+
+// A candidate must not be clearly worse than the active model on the canary set
+bool ClassifierHost::passes_canary(const EmotionClassifier& candidate) const {
+    std::string canary_path = model_dir_ + "/canary.txt";
+    size_t count = 0;
+    double new_acc = canary_accuracy(candidate, canary_path, count);
+    if (count == 0) return true; // no canary set shipped; warm-up already proved it runs
+
+    auto active = acquire();
+    double old_acc = active ? canary_accuracy(*active, canary_path, count) : 0.0;
+    std::cerr << "[RELOAD] canary accuracy " << new_acc << " (active " << old_acc << ")" << std::endl;
+    return new_acc + kCanaryTolerance >= old_acc;
+}
+
+// Swap in a validated model; the old one is parked until requests still on it are done
+bool ClassifierHost::reload() {
+    // A retrained model comes with its own vocabulary and labels; the configured ones
+    // (e.g. built into the GUI) belong to the model it started with
+    ClassifierConfig config = config_;
+    config.preprocessor.reset();
+    config.labels.clear();
+    auto candidate = load_candidate(config);
+    if (!candidate || !passes_canary(*candidate)) {
+        std::cerr << "[RELOAD] rejected model in " << model_dir_ << ", keeping the active one" << std::endl;
+        return false;
+    }
+    std::shared_ptr<const EmotionClassifier> retired =
+        std::atomic_exchange(&active_, std::shared_ptr<const EmotionClassifier>(candidate));
+    std::cerr << "[RELOAD] now serving model version " << candidate->version() << std::endl;
+    if (retired) {
+        std::lock_guard<std::mutex> lock(retired_mutex_);
+        retired_.push_back(std::move(retired));
+    }
+    release_retired();
+    return true;
+}
+
+// Free retired models nobody uses any more, so the TF session is torn down here and not
+// on a request thread that happens to drop the last snapshot
+void ClassifierHost::release_retired() {
+    std::vector<std::shared_ptr<const EmotionClassifier>> unused;
+    {
+        std::lock_guard<std::mutex> lock(retired_mutex_);
+        auto in_use = std::partition(retired_.begin(), retired_.end(),
+                                     [](const std::shared_ptr<const EmotionClassifier>& model) {
+                                         return model.use_count() > 1;
+                                     });
+        std::move(in_use, retired_.end(), std::back_inserter(unused));
+        retired_.erase(in_use, retired_.end());
+    }
+}
+
+void ClassifierHost::start_watching() {
+    if (!watcher_.joinable()) watcher_ = std::thread(&ClassifierHost::watch_loop, this);
+}
+
+#ifdef __linux__
+// train.py writes VERSION last (via rename), so its appearance marks a complete model
+void ClassifierHost::watch_loop() {
+    int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0 || inotify_add_watch(fd, model_dir_.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+        std::cerr << "[RELOAD] cannot watch " << model_dir_ << ", hot reload disabled" << std::endl;
+        if (fd >= 0) close(fd);
+        return;
+    }
+    alignas(inotify_event) char buf[4096];
+    while (!stop_) {
+        release_retired();
+        pollfd pfd = {fd, POLLIN, 0};
+        if (poll(&pfd, 1, 500) <= 0) continue;
+
+        bool new_version = false;
+        ssize_t len;
+        while ((len = read(fd, buf, sizeof(buf))) > 0) {
+            for (char* p = buf; p < buf + len;) {
+                auto* ev = reinterpret_cast<inotify_event*>(p);
+                if (ev->len && std::string(ev->name) == "VERSION") new_version = true;
+                p += sizeof(inotify_event) + ev->len;
+            }
+        }
+        if (new_version) reload();
+    }
+    close(fd);
+}
+#else
+void ClassifierHost::watch_loop() {
+    std::cerr << "[RELOAD] hot reload needs inotify and is disabled on this platform" << std::endl;
+}
+#endif
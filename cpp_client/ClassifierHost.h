@@ -0,0 +1,48 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "EmotionClassifier.h"
+
+// Owns the active classifier and swaps in new model versions without blocking readers.
+// Requests take a snapshot with acquire() and finish on it even if a swap happens meanwhile.
+class ClassifierHost {
+public:
+    explicit ClassifierHost(const std::string& model_dir, const ClassifierConfig& config = ClassifierConfig());
+    ~ClassifierHost();
+
+    ClassifierHost(const ClassifierHost&) = delete;
+    ClassifierHost& operator=(const ClassifierHost&) = delete;
+
+    // Load, warm up and activate the model currently in model_dir
+    bool load_initial();
+
+    // Load, warm up and validate the model in model_dir, then swap it in atomically.
+    // Returns after the swap; the old model is freed once its last request is done.
+    bool reload();
+
+    // Watch model_dir (inotify) and reload() whenever a new VERSION file is written
+    void start_watching();
+
+    // Current classifier, or null before load_initial() succeeded
+    std::shared_ptr<const EmotionClassifier> acquire() const;
+
+private:
+    std::string model_dir_;
+    ClassifierConfig config_;
+    std::shared_ptr<const EmotionClassifier> active_; // accessed only through std::atomic_load/store
+    std::atomic<bool> stop_{false};
+    std::thread watcher_;
+    std::mutex retired_mutex_;
+    std::vector<std::shared_ptr<const EmotionClassifier>> retired_; // swapped out, maybe still in use
+
+    std::shared_ptr<EmotionClassifier> load_candidate(const ClassifierConfig& config) const;
+    bool passes_canary(const EmotionClassifier& candidate) const;
+    void release_retired();
+    void watch_loop();
+};
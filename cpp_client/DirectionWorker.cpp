@@ -0,0 +1,75 @@
+#include "DirectionWorker.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#include <immintrin.h>
+#define CPU_RELAX() _mm_pause()
+#else
+#define CPU_RELAX() std::this_thread::yield()
+#endif
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// Iterations to spin for new work before sleeping (roughly 100us on current x86)
+static const int kSpinIterations = 20000;
+
+DirectionWorker::DirectionWorker() {
+    thread_ = std::thread(&DirectionWorker::loop, this);
+#ifdef __linux__
+    // Keep the helper on the last core so it does not migrate mid-handoff
+    unsigned cores = std::thread::hardware_concurrency();
+    if (cores > 1) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cores - 1, &set);
+        pthread_setaffinity_np(thread_.native_handle(), sizeof(set), &set);
+    }
+#endif
+}
+
+DirectionWorker::~DirectionWorker() {
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        stop_ = true;
+    }
+    wake_.notify_one();
+    thread_.join();
+}
+
+void DirectionWorker::post(void (*fn)(void*), void* arg) {
+    fn_ = fn;
+    arg_ = arg;
+    posted_.fetch_add(1);
+    if (sleeping_.load()) {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        wake_.notify_one();
+    }
+}
+
+void DirectionWorker::wait() {
+    while (done_.load(std::memory_order_acquire) != posted_.load(std::memory_order_relaxed))
+        CPU_RELAX();
+}
+
+// Spin for work, sleep when idle for a while, run each task once
+void DirectionWorker::loop() {
+    uint64_t seen = 0;
+    while (!stop_) {
+        int spins = 0;
+        while (posted_.load() == seen && !stop_ && spins++ < kSpinIterations)
+            CPU_RELAX();
+        if (posted_.load() == seen) {
+            std::unique_lock<std::mutex> lock(sleep_mutex_);
+            sleeping_ = true;
+            wake_.wait(lock, [&] { return posted_.load() != seen || stop_; });
+            sleeping_ = false;
+        }
+        if (stop_) break;
+
+        fn_(arg_);
+        seen = posted_.load();
+        done_.store(seen, std::memory_order_release);
+    }
+}
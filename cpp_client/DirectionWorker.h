@@ -0,0 +1,45 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+// A pinned helper thread that runs one task at a time handed over by spin-waiting.
+// Used to run the backward LSTM direction while the caller runs the forward one:
+// a batch-1 layer takes well under a millisecond, so waking a thread through the
+// kernel on every layer would eat most of the gain. The helper spins briefly for
+// new work and only then falls back to sleeping on a condition variable.
+class DirectionWorker {
+public:
+    DirectionWorker();
+    ~DirectionWorker();
+
+    DirectionWorker(const DirectionWorker&) = delete;
+    DirectionWorker& operator=(const DirectionWorker&) = delete;
+
+    // Claim the worker for one forward pass; false if another thread is using it
+    bool try_acquire() { return owner_.try_lock(); }
+    void release() { owner_.unlock(); }
+
+    // Start fn(arg) on the helper thread; only valid while acquired and idle
+    void post(void (*fn)(void*), void* arg);
+
+    // Spin until the posted task has finished
+    void wait();
+
+private:
+    std::thread thread_;
+    std::mutex owner_;
+    void (*fn_)(void*) = nullptr;
+    void* arg_ = nullptr;
+    std::atomic<uint64_t> posted_{0};
+    std::atomic<uint64_t> done_{0};
+    std::atomic<bool> sleeping_{false};
+    std::atomic<bool> stop_{false};
+    std::mutex sleep_mutex_;
+    std::condition_variable wake_;
+
+    void loop();
+};
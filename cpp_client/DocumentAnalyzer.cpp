@@ -0,0 +1,108 @@
+#include "DocumentAnalyzer.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstring>
+
+#include "TextPreprocessor.h"
+
+namespace {
+
+bool is_one_of(char c, const char* set) {
+    return c != '\0' && std::strchr(set, c) != nullptr;
+}
+
+// True if the whitespace-separated word [begin, end) finishes a sentence: its last
+// character, ignoring closing quotes and brackets, is . ! or ?
+bool ends_sentence(const std::string& text, size_t begin, size_t end) {
+    while (end > begin && is_one_of(text[end - 1], "\"')]}")) --end;
+    return end > begin && is_one_of(text[end - 1], ".!?");
+}
+
+// Add the segments of one sentence, given the byte ranges of its words
+void add_sentence(const std::vector<std::pair<size_t, size_t>>& words, size_t first, size_t last, int max_words,
+                  int overlap, std::vector<DocumentSegment>& segments) {
+    const size_t count = last - first;
+    if (count == 0) return;
+    const size_t window = (size_t)std::max(max_words, 1);
+    const size_t stride = window - (size_t)std::min(std::max(overlap, 0), (int)window - 1);
+    for (size_t start = 0;; start += stride) {
+        size_t stop = std::min(start + window, count);
+        DocumentSegment segment;
+        segment.begin = words[first + start].first;
+        segment.end = words[first + stop - 1].second;
+        segment.words = (int)(stop - start);
+        segments.push_back(segment);
+        if (stop == count) break;
+    }
+}
+
+} // namespace
+
+std::vector<DocumentSegment> split_document(const std::string& text, int max_words, int overlap) {
+    const std::vector<std::pair<size_t, size_t>> words = TextPreprocessor::word_spans(text);
+    std::vector<DocumentSegment> segments;
+    size_t first = 0;  // first word of the current sentence
+    size_t next = 0;   // next word to reach
+    size_t pos = 0;
+    while (pos < text.size()) {
+        // Whitespace: a line break ends the sentence
+        size_t word = pos;
+        while (word < text.size() && std::isspace((unsigned char)text[word])) {
+            if (text[word] == '\n' && next > first) {
+                add_sentence(words, first, next, max_words, overlap, segments);
+                first = next;
+            }
+            ++word;
+        }
+        size_t end = word;
+        while (end < text.size() && !std::isspace((unsigned char)text[end])) ++end;
+        if (end == word) break;
+        if (next < words.size() && words[next].first == word) ++next; // a word the model sees
+        if (ends_sentence(text, word, end) && next > first) {
+            add_sentence(words, first, next, max_words, overlap, segments);
+            first = next;
+        }
+        pos = end;
+    }
+    add_sentence(words, first, next, max_words, overlap, segments);
+    return segments;
+}
+
+DocumentAnalysis analyze_document(const std::shared_ptr<const EmotionClassifier>& model, const std::string& text) {
+    auto start = std::chrono::steady_clock::now();
+    DocumentAnalysis analysis;
+    if (!model) return analysis;
+    analysis.model_id = model->id();
+    analysis.labels = model->labels();
+    analysis.segments = split_document(text, model->max_len(), model->max_len() / 4);
+
+    std::vector<std::string> texts;
+    texts.reserve(analysis.segments.size());
+    for (const DocumentSegment& segment : analysis.segments)
+        texts.push_back(text.substr(segment.begin, segment.end - segment.begin));
+    std::vector<PredictionResult> results(texts.size());
+    if (!texts.empty()) model->predict_texts(texts, results.data());
+
+    // Longer segments carry more of the document, so they weigh more in the overall mix
+    float total_words = 0.0f;
+    for (size_t i = 0; i < results.size(); ++i) {
+        DocumentSegment& segment = analysis.segments[i];
+        segment.result = results[i];
+        segment.result.label = {}; // points into the model, which may be gone before the analysis
+        if (!segment.result.ok()) continue;
+        analysis.num_classes = segment.result.num_classes;
+        ++analysis.counts[segment.result.class_id];
+        for (int c = 0; c < segment.result.num_classes; ++c)
+            analysis.distribution[c] += segment.words * segment.result.probs[c];
+        total_words += segment.words;
+    }
+    if (total_words > 0.0f) {
+        for (float& p : analysis.distribution) p /= total_words;
+        analysis.class_id = (int)(std::max_element(analysis.distribution.begin(),
+                                                   analysis.distribution.begin() + analysis.num_classes) -
+                                  analysis.distribution.begin());
+    }
+    analysis.elapsed_ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return analysis;
+}
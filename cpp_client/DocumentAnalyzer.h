@@ -0,0 +1,41 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "EmotionClassifier.h"
+
+// One classified piece of a document: a sentence, or a window of a sentence longer than
+// the model's input
+struct DocumentSegment {
+    size_t begin = 0; // byte range [begin, end) in the document
+    size_t end = 0;
+    int words = 0;    // words the model saw
+    PredictionResult result; // result.label is left empty: use DocumentAnalysis::labels
+};
+
+// Emotions of a whole document, segment by segment and overall. It copies the labels, so
+// the model can be released (and a hot reload finish) while the analysis is on screen.
+struct DocumentAnalysis {
+    uint64_t model_id = 0;                          // EmotionClassifier::id() of the model, 0 if none
+    std::vector<std::string> labels;                // that model's labels, indexed by class id
+    std::vector<DocumentSegment> segments;          // in text order; windows of one sentence overlap
+    int num_classes = 0;
+    std::array<float, kMaxClasses> distribution{};  // word-weighted mean of the segment probabilities
+    std::array<int, kMaxClasses> counts{};          // segments per predicted class
+    int class_id = -1;                              // most likely class overall, -1 if nothing was classified
+    float elapsed_ms = 0.0f;
+};
+
+// Cut text into sentences (ending in . ! or ? or at a line break). A sentence of more than
+// max_words words becomes windows of max_words words, each overlapping the previous one
+// by overlap words. Pieces without a word are left out. Results are not filled in.
+std::vector<DocumentSegment> split_document(const std::string& text, int max_words, int overlap);
+
+// Split text with the model's input length (windows overlap by a quarter of it) and
+// classify every segment in one batch
+DocumentAnalysis analyze_document(const std::shared_ptr<const EmotionClassifier>& model, const std::string& text);
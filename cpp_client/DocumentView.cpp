@@ -0,0 +1,135 @@
+#include "DocumentView.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <utility>
+
+#include "imgui.h"
+
+namespace {
+
+// Highlight color of an emotion; gray for labels without one
+ImU32 emotion_color(std::string_view label, int alpha) {
+    if (label == "joy") return IM_COL32(230, 190, 40, alpha);
+    if (label == "love") return IM_COL32(235, 90, 160, alpha);
+    if (label == "surprise") return IM_COL32(240, 140, 40, alpha);
+    if (label == "sadness") return IM_COL32(70, 120, 230, alpha);
+    if (label == "anger") return IM_COL32(220, 50, 50, alpha);
+    if (label == "fear") return IM_COL32(140, 80, 200, alpha);
+    return IM_COL32(128, 128, 128, alpha);
+}
+
+} // namespace
+
+void DocumentView::set(DocumentAnalysis analysis, std::string text) {
+    analysis_ = std::move(analysis);
+    text_ = std::move(text);
+    layout_width_ = -1.0f;
+}
+
+void DocumentView::clear() {
+    analysis_ = DocumentAnalysis();
+    text_.clear();
+    words_.clear();
+    layout_width_ = -1.0f;
+}
+
+// Word wrap the whole text at width. Each word remembers the segment it belongs to; where
+// the windows of a long sentence overlap, the later window wins.
+void DocumentView::layout(float width) {
+    words_.clear();
+    layout_width_ = width;
+    layout_font_size_ = ImGui::GetFontSize();
+    const float space = ImGui::CalcTextSize(" ").x;
+    const float line_height = ImGui::GetTextLineHeightWithSpacing();
+    const std::vector<DocumentSegment>& segments = analysis_.segments;
+    float x = 0.0f, y = 0.0f;
+    size_t segment = 0;
+    size_t pos = 0;
+    while (pos < text_.size()) {
+        if (std::isspace((unsigned char)text_[pos])) {
+            if (text_[pos] == '\n') {
+                x = 0.0f;
+                y += line_height;
+            }
+            ++pos;
+            continue;
+        }
+        Word word;
+        word.begin = pos;
+        while (pos < text_.size() && !std::isspace((unsigned char)text_[pos])) ++pos;
+        word.end = pos;
+        word.width = ImGui::CalcTextSize(text_.data() + word.begin, text_.data() + word.end).x;
+        if (x > 0.0f && x + word.width > width) {
+            x = 0.0f;
+            y += line_height;
+        }
+        word.x = x;
+        word.y = y;
+        x += word.width + space;
+
+        while (segment + 1 < segments.size() && segments[segment + 1].begin <= word.begin) ++segment;
+        bool inside = segment < segments.size() && segments[segment].begin <= word.begin &&
+                      word.begin < segments[segment].end;
+        word.segment = inside ? (int)segment : -1;
+        words_.push_back(word);
+    }
+    height_ = y + line_height;
+}
+
+void DocumentView::draw() {
+    if (empty()) return;
+    const DocumentAnalysis& a = analysis_;
+    const std::vector<std::string>& labels = a.labels;
+    if (a.class_id < 0) {
+        ImGui::TextDisabled("No words to classify.");
+        return;
+    }
+
+    ImGui::Text("Overall: %s (%zu segments, %.0f ms)", labels[a.class_id].c_str(), a.segments.size(), a.elapsed_ms);
+    for (int i = 0; i < a.num_classes; ++i) {
+        char overlay[64];
+        snprintf(overlay, sizeof(overlay), "%s %.0f%% (%d)", labels[i].c_str(), 100.0f * a.distribution[i], a.counts[i]);
+        ImGui::PushStyleColor(ImGuiCol_PlotHistogram, emotion_color(labels[i], 255));
+        ImGui::ProgressBar(a.distribution[i], ImVec2(400, 0), overlay);
+        ImGui::PopStyleColor();
+    }
+
+    ImGui::BeginChild("##document", ImVec2(400, ImGui::GetTextLineHeightWithSpacing() * 10), ImGuiChildFlags_Borders);
+    draw_text();
+    ImGui::EndChild();
+}
+
+// Only the words on visible lines are drawn; the rest of the text is one Dummy for scrolling
+void DocumentView::draw_text() {
+    float width = ImGui::GetContentRegionAvail().x;
+    if (width != layout_width_ || ImGui::GetFontSize() != layout_font_size_) layout(width);
+
+    const ImVec2 origin = ImGui::GetCursorScreenPos();
+    const float top = ImGui::GetScrollY() - ImGui::GetTextLineHeightWithSpacing();
+    const float bottom = ImGui::GetScrollY() + ImGui::GetWindowHeight();
+    const float line_height = ImGui::GetTextLineHeight();
+    ImDrawList* draw_list = ImGui::GetWindowDrawList();
+    const bool hovered = ImGui::IsWindowHovered();
+    const ImU32 text_color = ImGui::GetColorU32(ImGuiCol_Text);
+
+    auto first = std::lower_bound(words_.begin(), words_.end(), top, [](const Word& w, float y) { return w.y < y; });
+    for (auto it = first; it != words_.end() && it->y < bottom; ++it) {
+        ImVec2 min(origin.x + it->x, origin.y + it->y);
+        ImVec2 max(min.x + it->width, min.y + line_height);
+        if (it->segment >= 0) {
+            const PredictionResult& result = analysis_.segments[it->segment].result;
+            if (result.ok()) draw_list->AddRectFilled(ImVec2(min.x - 2, min.y), ImVec2(max.x + 2, max.y),
+                                                      emotion_color(analysis_.labels[result.class_id], 110), 3.0f);
+            if (hovered && ImGui::IsMouseHoveringRect(min, max)) {
+                if (result.ok())
+                    ImGui::SetTooltip("Segment %d: %s (%.0f%%)", it->segment + 1,
+                                      analysis_.labels[result.class_id].c_str(), 100.0f * result.confidence());
+                else
+                    ImGui::SetTooltip("Segment %d: prediction failed", it->segment + 1);
+            }
+        }
+        draw_list->AddText(min, text_color, text_.data() + it->begin, text_.data() + it->end);
+    }
+    ImGui::Dummy(ImVec2(layout_width_, height_));
+}
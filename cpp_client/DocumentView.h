@@ -0,0 +1,39 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "DocumentAnalyzer.h"
+
+// GUI side of document mode. Shows the overall emotion mix of a DocumentAnalysis and
+// the document itself with every segment highlighted in its emotion's color (hover a
+// word for its segment's prediction). Words are laid out once per analysis and width,
+// and only the lines in view are drawn, so long documents stay cheap to redraw.
+class DocumentView {
+public:
+    // Show analysis of text; text must be the string the analysis was made from
+    void set(DocumentAnalysis analysis, std::string text);
+    void clear();
+    bool empty() const { return analysis_.model_id == 0; }
+    const DocumentAnalysis& analysis() const { return analysis_; }
+
+    // Draw into the current window; call once per frame on the UI thread
+    void draw();
+
+private:
+    struct Word {
+        size_t begin, end; // byte range in text_
+        float x, y, width; // relative to the top left of the text
+        int segment;       // index into analysis_.segments, -1 if the word was not classified
+    };
+
+    DocumentAnalysis analysis_;
+    std::string text_;
+    std::vector<Word> words_;
+    float layout_width_ = -1.0f;
+    float layout_font_size_ = 0.0f;
+    float height_ = 0.0f;
+
+    void layout(float width);
+    void draw_text();
+};
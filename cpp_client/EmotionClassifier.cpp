@@ -0,0 +1,334 @@
+#include "EmotionClassifier.h"
+#include "LabelUtils.h"
+#include "ScratchArena.h"
+#include "TFEngine.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+const char* const kClassifierUsage =
+    "  --backend tf|native                              inference engine (default tf)\n"
+    "  --directions auto|sequential|threaded            native BiLSTM direction scheduling\n"
+    "  --weights auto|fp32|fp16|bf16                    native weight storage (default: as exported)\n"
+    "  --mode exact|bucketed                            feed 100 steps or trimmed length buckets\n"
+    "  --warmup-batches 1,8,32                          batch sizes to warm up at load\n"
+    "  --cascade on|off                                 answer confident inputs with cascade.bundle first\n"
+    "  --cascade-threshold P                            cascade confidence cutoff (default: calibrated)";
+
+bool parse_classifier_option(const std::string& arg, const std::string& value, ClassifierConfig& config) {
+    if (arg == "--backend") {
+        if (value == "tf") config.backend = Backend::TensorFlow;
+        else if (value == "native") config.backend = Backend::Native;
+        else return false;
+    } else if (arg == "--directions") {
+        if (value == "auto") config.directions = DirectionMode::Auto;
+        else if (value == "sequential") config.directions = DirectionMode::Sequential;
+        else if (value == "threaded") config.directions = DirectionMode::Threaded;
+        else return false;
+    } else if (arg == "--weights") {
+        if (value == "auto") config.weights = WeightType::Auto;
+        else if (value == "fp32") config.weights = WeightType::F32;
+        else if (value == "fp16") config.weights = WeightType::F16;
+        else if (value == "bf16") config.weights = WeightType::BF16;
+        else return false;
+    } else if (arg == "--mode") {
+        if (value == "exact") config.mode = ExecutionMode::Exact;
+        else if (value == "bucketed") config.mode = ExecutionMode::Bucketed;
+        else return false;
+    } else if (arg == "--cascade") {
+        if (value == "on") config.cascade = true;
+        else if (value == "off") config.cascade = false;
+        else return false;
+    } else if (arg == "--cascade-threshold") {
+        config.cascade_threshold = (float)std::atof(value.c_str());
+        config.cascade = true;
+    } else if (arg == "--warmup-batches") {
+        config.warmup_batches.clear();
+        std::istringstream list(value);
+        std::string item;
+        while (std::getline(list, item, ','))
+            config.warmup_batches.push_back(std::atoi(item.c_str()));
+    } else {
+        return false;
+    }
+    return true;
+}
+
+static std::atomic<uint64_t> next_classifier_id{1};
+
+// export_frozen.py and export_bundle.py stamp their output with the VERSION it belongs to.
+// Files without a stamp (or a model without VERSION) predate the stamps and are trusted.
+static bool current_export(const std::string& path, const std::string& version) {
+    std::string stamp;
+    std::ifstream(path + ".version") >> stamp;
+    if (stamp.empty() || version.empty() || stamp == version) return true;
+    std::cerr << "Warning: " << path << " was exported for model version " << stamp << ", not " << version
+              << std::endl;
+    return false;
+}
+
+EmotionClassifier::EmotionClassifier(const ClassifierConfig& config)
+    : config_(config), id_(next_classifier_id++) {
+    std::sort(config_.length_buckets.begin(), config_.length_buckets.end());
+}
+
+// Load all model assets; everything stays resident for later calls
+bool EmotionClassifier::load(const std::string& model_dir) {
+    if (config_.preprocessor)
+        preprocessor_ = config_.preprocessor;
+    else
+        preprocessor_.reset(new TextPreprocessor(model_dir + "/word_index.txt", config_.max_len));
+    labels_ = config_.labels.empty() ? load_labels(model_dir + "/labels.txt") : config_.labels;
+    version_.clear();
+    std::ifstream(model_dir + "/VERSION") >> version_;
+    if (labels_.empty()) {
+        std::cerr << "ERROR: no labels found in " << model_dir << "/labels.txt" << std::endl;
+        return false;
+    }
+    if (labels_.size() > (size_t)kMaxClasses) {
+        std::cerr << "ERROR: " << labels_.size() << " labels in " << model_dir << "/labels.txt, results hold at most "
+                  << kMaxClasses << std::endl;
+        return false;
+    }
+
+    bool ok = false;
+    if (config_.backend == Backend::Native) {
+        std::string bundle_path = model_dir + "/model.bundle";
+        std::unique_ptr<NativeEngine> native(new NativeEngine(config_.directions, config_.weights));
+        if (!current_export(bundle_path, version_))
+            std::cerr << "ERROR: re-run export_bundle.py for the current model" << std::endl;
+        else
+            ok = native->load(bundle_path);
+        engine_ = std::move(native);
+    } else {
+        std::unique_ptr<TFEngine> tf(new TFEngine());
+        std::string frozen_path = model_dir + "/frozen_model.pb";
+        bool frozen = std::ifstream(frozen_path).good();
+        if (frozen && !current_export(frozen_path, version_)) {
+            std::cerr << "Warning: using saved_model instead; re-run export_frozen.py for the fast path" << std::endl;
+            frozen = false;
+        }
+        ok = frozen ? tf->load_frozen(frozen_path) : tf->load(model_dir + "/saved_model");
+        engine_ = std::move(tf);
+    }
+    if (!ok) engine_.reset();
+    if (ok && config_.cascade) {
+        cascade_.reset(new CascadeModel());
+        if (!cascade_->load(model_dir + "/cascade.bundle")) {
+            std::cerr << "Warning: cascade disabled, every input goes to the full model. "
+                         "train.py writes cascade.bundle." << std::endl;
+            cascade_.reset();
+        } else if (config_.cascade_threshold > 0.0f) {
+            cascade_->set_threshold(config_.cascade_threshold);
+        }
+    }
+    if (ok && config_.mode == ExecutionMode::Bucketed && !engine_->dynamic_length())
+        std::cerr << "Warning: model has a fixed input length, running in exact mode. "
+                     "Export it with export_frozen.py --dynamic-length for bucketed mode." << std::endl;
+    return ok;
+}
+
+bool EmotionClassifier::bucketed() const {
+    return config_.mode == ExecutionMode::Bucketed && engine_ && engine_->dynamic_length();
+}
+
+// Smallest configured bucket that fits length, capped at max_len
+int EmotionClassifier::bucket_for(int length) const {
+    for (int bucket : config_.length_buckets) {
+        if (bucket >= length && bucket <= config_.max_len) return bucket;
+    }
+    return config_.max_len;
+}
+
+// Warm the session up with representative input at every configured batch size
+bool EmotionClassifier::warm_up() const {
+    if (!preprocessor_ || !engine_) return false;
+    std::vector<float> sample = preprocessor_->preprocess("i feel a little nervous but mostly happy today");
+    size_t sample_len = std::find(sample.begin(), sample.end(), 0.0f) - sample.begin();
+
+    // In bucketed mode every bucket is a distinct input shape and needs its own warm-up
+    std::vector<int> lengths = {config_.max_len};
+    if (bucketed()) lengths = config_.length_buckets;
+
+    for (int batch_size : config_.warmup_batches) {
+        if (batch_size <= 0) continue;
+        for (int length : lengths) {
+            std::vector<float> seq(config_.max_len, 0.0f);
+            for (int i = 0; i < std::min(length, config_.max_len) && sample_len > 0; ++i)
+                seq[i] = sample[i % sample_len];
+            std::vector<std::vector<float>> batch(batch_size, seq);
+            if (classify_batch(batch, false)[0] == "error") return false;
+        }
+    }
+    return true;
+}
+
+namespace {
+
+float us_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<float, std::micro>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+// Input length for seq in bucketed mode: the bucket that fits it without trailing padding
+int EmotionClassifier::trimmed_length(const std::vector<float>& seq) const {
+    auto last = std::find_if(seq.rbegin(), seq.rend(), [](float v) { return v != 0.0f; });
+    return bucket_for(std::max(1, (int)(seq.rend() - last)));
+}
+
+PredictionResult EmotionClassifier::predict(const std::string& text, bool use_cascade) const {
+    PredictionResult result;
+    if (!preprocessor_) return result;
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::vector<float>> sequences = {preprocessor_->preprocess(text)};
+    float preprocess_us = us_since(start);
+    predict_batch(sequences, &result, use_cascade);
+    result.timings.preprocess_us = preprocess_us;
+    return result;
+}
+
+void EmotionClassifier::predict_texts(const std::vector<std::string>& texts, PredictionResult* results,
+                                      bool use_cascade) const {
+    if (!preprocessor_) {
+        std::fill(results, results + texts.size(), PredictionResult());
+        return;
+    }
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::vector<float>> sequences;
+    sequences.reserve(texts.size());
+    for (const std::string& text : texts) sequences.push_back(preprocessor_->preprocess(text));
+    float preprocess_us = texts.empty() ? 0.0f : us_since(start) / texts.size();
+    predict_batch(sequences, results, use_cascade);
+    for (size_t i = 0; i < texts.size(); ++i) results[i].timings.preprocess_us = preprocess_us;
+}
+
+std::string EmotionClassifier::classify(const std::string& text) const {
+    PredictionResult result = predict(text);
+    return result.ok() ? std::string(result.label) : "error";
+}
+
+std::vector<std::string> EmotionClassifier::classify_batch(const std::vector<std::vector<float>>& sequences,
+                                                           bool use_cascade) const {
+    std::vector<PredictionResult> results(sequences.size());
+    predict_batch(sequences, results.data(), use_cascade);
+    std::vector<std::string> labels;
+    labels.reserve(results.size());
+    for (const PredictionResult& result : results)
+        labels.push_back(result.ok() ? std::string(result.label) : "error");
+    return labels;
+}
+
+// Same input length as predict_batch would use, so live results match the Predict button
+PredictionResult EmotionClassifier::predict_incremental(const std::string& text, PrefixCache& cache,
+                                                        const std::atomic<bool>* cancel) const {
+    PredictionResult result;
+    if (!preprocessor_ || !engine_) return result;
+    auto start = std::chrono::steady_clock::now();
+    std::vector<float> seq = preprocessor_->preprocess(text);
+    int seq_len = bucketed() ? trimmed_length(seq) : config_.max_len;
+    result.timings.preprocess_us = us_since(start);
+
+    start = std::chrono::steady_clock::now();
+    static thread_local std::vector<float> scores; // keeps its capacity between calls
+    bool ok = engine_->run_incremental(seq.data(), seq_len, cache, scores, cancel);
+    result.timings.inference_us = us_since(start);
+    if (!ok) {
+        result.status = cancel && cancel->load() ? PredictionStatus::Cancelled : PredictionStatus::Failed;
+    } else if (scores.size() != labels_.size()) {
+        result.status = PredictionStatus::Failed;
+    } else {
+        start = std::chrono::steady_clock::now();
+        result.set_scores(scores.data(), labels_);
+        result.timings.postprocess_us = us_since(start);
+    }
+    return result;
+}
+
+// Run count sequences as one [count, seq_len] batch, keeping the first seq_len steps
+void EmotionClassifier::run_group(const std::vector<std::vector<float>>& sequences, const size_t* members,
+                                  size_t count, int seq_len, PredictionResult* results) const {
+    ScratchArena::Scope scope;
+    float* input = ScratchArena::local().floats(count * seq_len);
+    for (size_t k = 0; k < count; ++k)
+        std::copy(sequences[members[k]].begin(), sequences[members[k]].begin() + seq_len, input + k * seq_len);
+
+    auto start = std::chrono::steady_clock::now();
+    static thread_local std::vector<float> scores; // keeps its capacity between calls
+    bool ok = engine_ && engine_->run(input, (int)count, seq_len, scores);
+    float inference_us = us_since(start);
+
+    size_t num_classes = labels_.size();
+    if (ok && scores.size() != num_classes * count) {
+        std::cerr << "Warning: Output size (" << scores.size()
+                  << ") does not match number of labels (" << num_classes << ")." << std::endl;
+        ok = false;
+    }
+    for (size_t k = 0; k < count; ++k) {
+        PredictionResult& result = results[members[k]];
+        result.timings.inference_us = inference_us;
+        if (!ok) {
+            result.status = PredictionStatus::Failed;
+            continue;
+        }
+        start = std::chrono::steady_clock::now();
+        result.set_scores(scores.data() + k * num_classes, labels_);
+        result.timings.postprocess_us = us_since(start);
+    }
+}
+
+// The cascade answers what it can, the rest runs as one batch (exact mode) or one
+// batch per length bucket. Index lists live in the thread's scratch arena.
+void EmotionClassifier::predict_batch(const std::vector<std::vector<float>>& sequences, PredictionResult* results,
+                                      bool use_cascade) const {
+    const size_t n = sequences.size();
+    std::fill(results, results + n, PredictionResult());
+    if (!engine_ || n == 0) return;
+
+    ScratchArena::Scope scope;
+    ScratchArena& arena = ScratchArena::local();
+    size_t* pending = static_cast<size_t*>(arena.allocate(n * sizeof(size_t)));
+    size_t count = 0;
+    if (cascade_ && use_cascade && cascade_->num_classes() == (int)labels_.size()) {
+        float probs[kMaxClasses];
+        for (size_t i = 0; i < n; ++i) {
+            auto start = std::chrono::steady_clock::now();
+            if (cascade_->classify(sequences[i].data(), (int)sequences[i].size(), probs)) {
+                results[i].timings.inference_us = us_since(start);
+                results[i].set_scores(probs, labels_);
+                results[i].from_cascade = true;
+            } else {
+                pending[count++] = i;
+            }
+        }
+        cascade_seen_ += n;
+        cascade_answered_ += n - count;
+    } else {
+        for (size_t i = 0; i < n; ++i) pending[count++] = i;
+    }
+    if (count == 0) return;
+
+    if (!bucketed()) {
+        run_group(sequences, pending, count, config_.max_len, results);
+        return;
+    }
+
+    // Group by bucket: take the bucket of the first ungrouped sequence, gather all of its members
+    int* bucket = static_cast<int*>(arena.allocate(count * sizeof(int)));
+    size_t* members = static_cast<size_t*>(arena.allocate(count * sizeof(size_t)));
+    for (size_t k = 0; k < count; ++k) bucket[k] = trimmed_length(sequences[pending[k]]);
+    for (size_t first = 0; first < count; ++first) {
+        if (bucket[first] == 0) continue;
+        int seq_len = bucket[first];
+        size_t size = 0;
+        for (size_t k = first; k < count; ++k) {
+            if (bucket[k] != seq_len) continue;
+            members[size++] = pending[k];
+            bucket[k] = 0;
+        }
+        run_group(sequences, members, size, seq_len, results);
+    }
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "CascadeModel.h"
+#include "InferenceEngine.h"
+#include "NativeEngine.h"
+#include "PredictionResult.h"
+#include "TextPreprocessor.h"
+
+// How sequences are fed to the model; chosen per deployment
+enum class ExecutionMode {
+    Exact,    // always run max_len steps, identical to the padded training setup
+    Bucketed, // trim trailing padding up to the next length bucket (needs a dynamic-length export)
+};
+
+// Which engine runs the model
+enum class Backend {
+    TensorFlow, // frozen_model.pb or saved_model/ through the TF C API
+    Native,     // model.bundle through the built-in C++ forward pass
+};
+
+// Deployment settings shared by every classifier a host loads
+struct ClassifierConfig {
+    Backend backend = Backend::TensorFlow;
+    DirectionMode directions = DirectionMode::Auto; // native backend only
+    WeightType weights = WeightType::Auto;          // native backend only
+    int max_len = 100;
+    ExecutionMode mode = ExecutionMode::Exact;
+    std::vector<int> length_buckets = {16, 32, 64, 100};
+    std::vector<int> warmup_batches = {1};
+    bool cascade = false;          // answer confident inputs with cascade.bundle before the full model
+    float cascade_threshold = 0.0f; // 0 keeps the threshold calibrated by train.py
+
+    // Vocabulary and labels to use instead of model_dir's word_index.txt and labels.txt
+    // (gui_main passes the copies built into it). Hot reloads read the new model's files.
+    std::shared_ptr<const TextPreprocessor> preprocessor;
+    std::vector<std::string> labels;
+};
+
+// Apply one command-line option (--backend, --directions, --weights, --mode, --warmup-batches,
+// --cascade, --cascade-threshold) to config.
+// Returns false if arg is not a classifier option or value is invalid.
+bool parse_classifier_option(const std::string& arg, const std::string& value, ClassifierConfig& config);
+
+// Usage lines for the options understood by parse_classifier_option
+extern const char* const kClassifierUsage;
+
+// Bundles the vocabulary, label list and a resident inference engine
+class EmotionClassifier {
+public:
+    explicit EmotionClassifier(const ClassifierConfig& config = ClassifierConfig());
+
+    // Load word_index.txt, labels.txt, the model and the optional VERSION tag from model_dir
+    // (vocabulary and labels come from the config instead when it provides them).
+    // TensorFlow uses frozen_model.pb when present (fast path), otherwise saved_model/;
+    // the native backend uses model.bundle. With cascade enabled, cascade.bundle too.
+    // An exported file whose <file>.version stamp differs from VERSION is from an earlier
+    // training run: a stale frozen_model.pb is skipped, a stale model.bundle fails the load.
+    bool load(const std::string& model_dir);
+
+    // Run a dummy batch of each configured size (and length bucket) so graph optimization,
+    // kernel selection and allocator growth happen now instead of on the first real request
+    bool warm_up() const;
+
+    // Classify one text, with probabilities and stage timings
+    PredictionResult predict(const std::string& text, bool use_cascade = true) const;
+
+    // Classify already preprocessed sequences into results[0, sequences.size()), which the
+    // caller owns; one session run per length bucket in use. Inputs the cascade is confident
+    // about never reach the full model unless use_cascade is false.
+    void predict_batch(const std::vector<std::vector<float>>& sequences, PredictionResult* results,
+                       bool use_cascade = true) const;
+
+    // Preprocess and classify texts into results[0, texts.size())
+    void predict_texts(const std::vector<std::string>& texts, PredictionResult* results,
+                       bool use_cascade = true) const;
+
+    // Label-only forms of predict and predict_batch; "error" for failed inputs
+    std::string classify(const std::string& text) const;
+    std::vector<std::string> classify_batch(const std::vector<std::vector<float>>& sequences,
+                                            bool use_cascade = true) const;
+
+    // Predict text as it is being typed. cache carries the engine's work from the caller's
+    // previous call, so an edit near the end costs less than a full pass. The status is
+    // Cancelled once *cancel is set before the run completes.
+    PredictionResult predict_incremental(const std::string& text, PrefixCache& cache,
+                                         const std::atomic<bool>* cancel = nullptr) const;
+
+    // Inputs seen by the cascade and how many of them it answered
+    struct CascadeStats {
+        uint64_t seen;
+        uint64_t answered;
+    };
+    CascadeStats cascade_stats() const { return {cascade_seen_.load(), cascade_answered_.load()}; }
+    bool has_cascade() const { return cascade_ != nullptr; }
+
+    const TextPreprocessor& preprocessor() const { return *preprocessor_; }
+    const std::vector<std::string>& labels() const { return labels_; }
+    int max_len() const { return config_.max_len; }
+    const std::string& version() const { return version_; }
+
+    // Distinct for every classifier created in this process, so a caller can tell whether
+    // a result came from the model it saw last without keeping that model alive
+    uint64_t id() const { return id_; }
+
+private:
+    std::shared_ptr<const TextPreprocessor> preprocessor_;
+    std::vector<std::string> labels_;
+    std::unique_ptr<InferenceEngine> engine_;
+    std::unique_ptr<CascadeModel> cascade_;
+    mutable std::atomic<uint64_t> cascade_seen_{0};
+    mutable std::atomic<uint64_t> cascade_answered_{0};
+    ClassifierConfig config_;
+    std::string version_;
+    uint64_t id_;
+
+    bool bucketed() const;
+    int bucket_for(int length) const;
+    int trimmed_length(const std::vector<float>& seq) const;
+    void run_group(const std::vector<std::vector<float>>& sequences, const size_t* members, size_t count,
+                   int seq_len, PredictionResult* results) const;
+};
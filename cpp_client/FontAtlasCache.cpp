@@ -0,0 +1,201 @@
+#include "FontAtlasCache.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include "imgui.h"
+#include "imgui_internal.h"
+
+namespace {
+
+const uint32_t kCacheVersion = 1;
+
+// 64-bit FNV-1a over everything that changes what the font builder produces
+struct KeyHasher {
+    uint64_t h = 1469598103934665603ULL;
+
+    void bytes(const void* data, size_t len) {
+        const unsigned char* p = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < len; ++i) {
+            h ^= p[i];
+            h *= 1099511628211ULL;
+        }
+    }
+
+    template <typename T>
+    void value(const T& v) { bytes(&v, sizeof(v)); }
+};
+
+uint64_t atlas_key(ImFontAtlas* atlas) {
+    KeyHasher key;
+    key.value(kCacheVersion);
+    key.value(IMGUI_VERSION_NUM);
+    key.value(sizeof(ImFontGlyph));
+    key.value(atlas->Flags);
+    key.value(atlas->TexDesiredWidth);
+    key.value(atlas->TexGlyphPadding);
+    key.value(atlas->FontBuilderFlags);
+    key.value(atlas->Fonts.Size);
+    for (const ImFontConfig& src : atlas->Sources) {
+        key.bytes(src.FontData, (size_t)src.FontDataSize);
+        key.value(src.FontNo);
+        key.value(src.MergeMode);
+        key.value(src.PixelSnapH);
+        key.value(src.OversampleH);
+        key.value(src.OversampleV);
+        key.value(src.SizePixels);
+        key.value(src.GlyphOffset.x);
+        key.value(src.GlyphOffset.y);
+        key.value(src.GlyphMinAdvanceX);
+        key.value(src.GlyphMaxAdvanceX);
+        key.value(src.GlyphExtraAdvanceX);
+        key.value(src.FontBuilderFlags);
+        key.value(src.RasterizerMultiply);
+        key.value(src.RasterizerDensity);
+        key.value(src.EllipsisChar);
+        for (const ImWchar* range = src.GlyphRanges ? src.GlyphRanges : atlas->GetGlyphRangesDefault(); *range; ++range)
+            key.value(*range);
+        key.value(ImWchar(0));
+    }
+    for (const ImFontAtlasCustomRect& rect : atlas->CustomRects) {
+        key.value(rect.Width);
+        key.value(rect.Height);
+        key.value(rect.GlyphID);
+    }
+    return key.h;
+}
+
+// Output of the builder for one ImFont
+struct CachedFont {
+    float ascent = 0.0f;
+    float descent = 0.0f;
+    int32_t surface = 0;
+    ImVector<ImFontGlyph> glyphs;
+};
+
+template <typename T>
+bool read_value(std::ifstream& in, T& value) {
+    return (bool)in.read(reinterpret_cast<char*>(&value), sizeof(value));
+}
+
+template <typename T>
+void write_value(std::ofstream& out, const T& value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+// Install the atlas stored at path if it was baked under key; leaves atlas untouched otherwise
+bool load_atlas(ImFontAtlas* atlas, const std::string& path, uint64_t key) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+    char magic[4];
+    uint32_t version = 0, rect_count = 0, font_count = 0;
+    uint64_t stored_key = 0;
+    int32_t width = 0, height = 0;
+    if (!in.read(magic, 4) || std::memcmp(magic, "EMFA", 4) != 0 || !read_value(in, version) ||
+        version != kCacheVersion || !read_value(in, stored_key) || stored_key != key || !read_value(in, width) ||
+        !read_value(in, height) || !read_value(in, rect_count) || !read_value(in, font_count) ||
+        width <= 0 || height <= 0 || (int)rect_count != atlas->CustomRects.Size || (int)font_count != atlas->Fonts.Size)
+        return false;
+
+    std::vector<unsigned short> rect_pos(rect_count * 2);
+    std::vector<unsigned char> pixels((size_t)width * height);
+    if (!in.read(reinterpret_cast<char*>(rect_pos.data()), rect_pos.size() * sizeof(unsigned short)) ||
+        !in.read(reinterpret_cast<char*>(pixels.data()), pixels.size()))
+        return false;
+    std::vector<CachedFont> fonts(font_count);
+    for (CachedFont& font : fonts) {
+        uint32_t glyph_count = 0;
+        if (!read_value(in, font.ascent) || !read_value(in, font.descent) || !read_value(in, font.surface) ||
+            !read_value(in, glyph_count) || glyph_count >= 0xFFFF)
+            return false;
+        font.glyphs.resize((int)glyph_count);
+        if (!in.read(reinterpret_cast<char*>(font.glyphs.Data), (std::streamsize)font.glyphs.size_in_bytes()))
+            return false;
+    }
+
+    // Same state ImFontAtlasBuildWithStbTruetype leaves behind, minus the rasterizing
+    atlas->TexID = (ImTextureID)NULL;
+    atlas->ClearTexData();
+    atlas->TexWidth = width;
+    atlas->TexHeight = height;
+    atlas->TexUvScale = ImVec2(1.0f / width, 1.0f / height);
+    atlas->TexPixelsAlpha8 = (unsigned char*)IM_ALLOC(pixels.size());
+    std::memcpy(atlas->TexPixelsAlpha8, pixels.data(), pixels.size());
+    for (int i = 0; i < atlas->CustomRects.Size; ++i) {
+        atlas->CustomRects[i].X = rect_pos[i * 2];
+        atlas->CustomRects[i].Y = rect_pos[i * 2 + 1];
+    }
+    for (int i = 0; i < atlas->Fonts.Size; ++i) {
+        ImFont* font = atlas->Fonts[i];
+        ImFontAtlasBuildSetupFont(atlas, font, font->Sources, fonts[i].ascent, fonts[i].descent);
+        font->Glyphs.swap(fonts[i].glyphs);
+        font->MetricsTotalSurface = fonts[i].surface;
+        font->DirtyLookupTables = true;
+    }
+    ImFontAtlasBuildFinish(atlas); // cursor and line pixels, white pixel UV, lookup tables
+    return true;
+}
+
+// Write through a temporary file so an interrupted run never leaves a torn cache behind
+bool save_atlas(const ImFontAtlas* atlas, const std::string& path, uint64_t key) {
+    const std::string tmp_path = path + ".tmp";
+    {
+        std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+        if (!out) return false;
+        out.write("EMFA", 4);
+        write_value(out, kCacheVersion);
+        write_value(out, key);
+        write_value(out, (int32_t)atlas->TexWidth);
+        write_value(out, (int32_t)atlas->TexHeight);
+        write_value(out, (uint32_t)atlas->CustomRects.Size);
+        write_value(out, (uint32_t)atlas->Fonts.Size);
+        for (const ImFontAtlasCustomRect& rect : atlas->CustomRects) {
+            write_value(out, rect.X);
+            write_value(out, rect.Y);
+        }
+        out.write(reinterpret_cast<const char*>(atlas->TexPixelsAlpha8), (std::streamsize)atlas->TexWidth * atlas->TexHeight);
+        for (const ImFont* font : atlas->Fonts) {
+            write_value(out, font->Ascent);
+            write_value(out, font->Descent);
+            write_value(out, (int32_t)font->MetricsTotalSurface);
+            write_value(out, (uint32_t)font->Glyphs.Size);
+            out.write(reinterpret_cast<const char*>(font->Glyphs.Data), (std::streamsize)font->Glyphs.size_in_bytes());
+        }
+        if (!out.flush()) return false;
+    }
+    std::remove(path.c_str()); // rename() does not replace an existing file on Windows
+    return std::rename(tmp_path.c_str(), path.c_str()) == 0;
+}
+
+// Custom rectangles mapped to glyphs get added to their font by ImFontAtlasBuildFinish,
+// which would then run twice over the cached glyphs
+bool has_custom_glyphs(const ImFontAtlas* atlas) {
+    for (const ImFontAtlasCustomRect& rect : atlas->CustomRects)
+        if (rect.Font != NULL && rect.GlyphID != 0) return true;
+    return false;
+}
+
+} // namespace
+
+bool build_font_atlas(ImFontAtlas* atlas, const std::string& cache_path) {
+    if (atlas->Sources.Size == 0) atlas->AddFontDefault();
+    if (cache_path.empty() || has_custom_glyphs(atlas)) {
+        atlas->Build();
+        return false;
+    }
+
+    ImFontAtlasBuildInit(atlas); // registers the cursor and line rectangles, which the key covers
+    const uint64_t key = atlas_key(atlas);
+    if (load_atlas(atlas, cache_path, key)) return true;
+
+    if (!atlas->Build()) {
+        std::cerr << "ERROR: could not rasterize the fonts" << std::endl;
+        return false;
+    }
+    if (!save_atlas(atlas, cache_path, key))
+        std::cerr << "WARNING: could not write font atlas cache " << cache_path << std::endl;
+    return false;
+}
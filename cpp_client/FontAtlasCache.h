@@ -0,0 +1,12 @@
+#pragma once
+
+#include <string>
+
+struct ImFontAtlas;
+
+// Build the ImGui font atlas now instead of on the first frame. With a cache_path, an
+// atlas baked by an earlier run (pixels plus glyph metrics) is loaded from it when the
+// font files, sizes, glyph ranges and atlas settings are unchanged, skipping
+// rasterization; otherwise the fonts are rasterized and the result is written there
+// for next time. Call after every AddFont* call. Returns true if the cache was used.
+bool build_font_atlas(ImFontAtlas* atlas, const std::string& cache_path);
@@ -0,0 +1,161 @@
+#include "GemmKernels.h"
+
+#ifdef EMOTION_GEMM_SIMD
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// One SIMD register holds the kPackTile lanes of one gate
+#if defined(__AVX512F__)
+using Vec = __m512;
+// The unmasked forms of some conversions pass _mm512_undefined_epi32() as their merge
+// source, which GCC 12 reports as -Wmaybe-uninitialized; zero-masking every lane emits
+// the same instructions without it
+constexpr __mmask16 kAllLanes = 0xFFFF;
+inline Vec vload(const float* p) { return _mm512_loadu_ps(p); }
+inline void vstore(float* p, Vec v) { _mm512_storeu_ps(p, v); }
+inline Vec vbroadcast(float x) { return _mm512_set1_ps(x); }
+inline Vec vfmadd(Vec a, Vec b, Vec c) { return _mm512_fmadd_ps(a, b, c); }
+#elif defined(EMOTION_GEMM_SIMD)
+using Vec = __m256;
+inline Vec vload(const float* p) { return _mm256_loadu_ps(p); }
+inline void vstore(float* p, Vec v) { _mm256_storeu_ps(p, v); }
+inline Vec vbroadcast(float x) { return _mm256_set1_ps(x); }
+inline Vec vfmadd(Vec a, Vec b, Vec c) { return _mm256_fmadd_ps(a, b, c); }
+#endif
+
+// Panel element types: how to widen one value, and one register of kPackTile values
+struct F32Panel {
+    using Element = float;
+    static constexpr bool kSimd = kGemmSimd;
+    static float widen(float v) { return v; }
+#ifdef EMOTION_GEMM_SIMD
+    static Vec load(const float* p) { return vload(p); }
+#endif
+};
+
+struct F16Panel {
+    using Element = uint16_t;
+#ifdef EMOTION_GEMM_F16
+    static constexpr bool kSimd = true;
+#if defined(__AVX512F__)
+    static Vec load(const uint16_t* p) {
+        return _mm512_maskz_cvtph_ps(kAllLanes, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)));
+    }
+#else
+    static Vec load(const uint16_t* p) { return _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))); }
+#endif
+#else
+    static constexpr bool kSimd = false;
+#endif
+    static float widen(uint16_t v) { return half_to_float(v); }
+};
+
+struct Bf16Panel {
+    using Element = uint16_t;
+    static constexpr bool kSimd = kGemmSimd;
+#if defined(__AVX512F__)
+    static Vec load(const uint16_t* p) {
+        __m512i wide = _mm512_maskz_cvtepu16_epi32(kAllLanes, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)));
+        return _mm512_castsi512_ps(_mm512_maskz_slli_epi32(kAllLanes, wide, 16));
+    }
+#elif defined(EMOTION_GEMM_SIMD)
+    static Vec load(const uint16_t* p) {
+        __m256i wide = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+        return _mm256_castsi256_ps(_mm256_slli_epi32(wide, 16));
+    }
+#endif
+    static float widen(uint16_t v) { return bf16_to_float(v); }
+};
+
+// MR x kPanelWidth block kept in registers for the whole k loop: every panel
+// row is loaded (and widened) once and used by all MR rows of A. K > 0 replaces the
+// runtime k, so the row loop has a constant trip count.
+template <int K, int MR, typename Panel>
+void gemm_block(const float* a, int lda, int k, const typename Panel::Element* panel, float* c, int ldc) {
+    if constexpr (K > 0) k = K;
+#ifdef EMOTION_GEMM_SIMD
+    if constexpr (Panel::kSimd) {
+        Vec acc[MR][4] = {};
+        for (int i = 0; i < MR; ++i)
+            for (int g = 0; g < 4; ++g) acc[i][g] = vload(c + (size_t)i * ldc + g * kPackTile);
+        for (int r = 0; r < k; ++r) {
+            const typename Panel::Element* row = panel + (size_t)r * kPanelWidth;
+            Vec b0 = Panel::load(row), b1 = Panel::load(row + kPackTile);
+            Vec b2 = Panel::load(row + 2 * kPackTile), b3 = Panel::load(row + 3 * kPackTile);
+            for (int i = 0; i < MR; ++i) {
+                Vec ai = vbroadcast(a[(size_t)i * lda + r]);
+                acc[i][0] = vfmadd(ai, b0, acc[i][0]);
+                acc[i][1] = vfmadd(ai, b1, acc[i][1]);
+                acc[i][2] = vfmadd(ai, b2, acc[i][2]);
+                acc[i][3] = vfmadd(ai, b3, acc[i][3]);
+            }
+        }
+        for (int i = 0; i < MR; ++i)
+            for (int g = 0; g < 4; ++g) vstore(c + (size_t)i * ldc + g * kPackTile, acc[i][g]);
+        return;
+    }
+#endif
+    // Portable version: fixed-width inner loop the compiler can vectorize
+    float acc[MR][kPanelWidth] = {};
+    for (int i = 0; i < MR; ++i)
+        for (int l = 0; l < kPanelWidth; ++l) acc[i][l] = c[(size_t)i * ldc + l];
+    for (int r = 0; r < k; ++r) {
+        float row[kPanelWidth];
+        for (int l = 0; l < kPanelWidth; ++l) row[l] = Panel::widen(panel[(size_t)r * kPanelWidth + l]);
+        for (int i = 0; i < MR; ++i) {
+            float ai = a[(size_t)i * lda + r];
+            for (int l = 0; l < kPanelWidth; ++l) acc[i][l] += ai * row[l];
+        }
+    }
+    for (int i = 0; i < MR; ++i)
+        for (int l = 0; l < kPanelWidth; ++l) c[(size_t)i * ldc + l] = acc[i][l];
+}
+
+// Dispatch a tail of fewer than kGemmRows rows to the block of exactly that height
+template <int K, int MR, typename Panel>
+void gemm_tail(const float* a, int lda, int rows, int k, const typename Panel::Element* panel, float* c, int ldc) {
+    if constexpr (MR > 0) {
+        if (rows == MR) gemm_block<K, MR, Panel>(a, lda, k, panel, c, ldc);
+        else gemm_tail<K, MR - 1, Panel>(a, lda, rows, k, panel, c, ldc);
+    }
+}
+
+template <int K, typename Panel>
+void gemm_rows(const float* a, int lda, int rows, int k, const typename Panel::Element* panel, float* c, int ldc) {
+    if (rows >= kGemmRows) gemm_block<K, kGemmRows, Panel>(a, lda, k, panel, c, ldc);
+    else gemm_tail<K, kGemmRows - 1, Panel>(a, lda, rows, k, panel, c, ldc);
+}
+
+} // namespace
+
+void gemm_panel(const float* a, int lda, int rows, int k, const float* panel, float* c, int ldc) {
+    gemm_rows<0, F32Panel>(a, lda, rows, k, panel, c, ldc);
+}
+
+void gemm_panel(const float* a, int lda, int rows, int k, const uint16_t* panel, WeightType type, float* c, int ldc) {
+    if (type == WeightType::BF16) gemm_rows<0, Bf16Panel>(a, lda, rows, k, panel, c, ldc);
+    else gemm_rows<0, F16Panel>(a, lda, rows, k, panel, c, ldc);
+}
+
+template <int K>
+void gemm_panel_k(const float* a, int lda, int rows, const float* panel, float* c, int ldc) {
+    gemm_rows<K, F32Panel>(a, lda, rows, K, panel, c, ldc);
+}
+
+template <int K>
+void gemm_panel_k(const float* a, int lda, int rows, const uint16_t* panel, WeightType type, float* c, int ldc) {
+    if (type == WeightType::BF16) gemm_rows<K, Bf16Panel>(a, lda, rows, K, panel, c, ldc);
+    else gemm_rows<K, F16Panel>(a, lda, rows, K, panel, c, ldc);
+}
+
+// The input and recurrent depths of the specialized LSTM shapes (see select_lstm_kernel)
+template void gemm_panel_k<300>(const float*, int, int, const float*, float*, int);
+template void gemm_panel_k<300>(const float*, int, int, const uint16_t*, WeightType, float*, int);
+template void gemm_panel_k<128>(const float*, int, int, const float*, float*, int);
+template void gemm_panel_k<128>(const float*, int, int, const uint16_t*, WeightType, float*, int);
+template void gemm_panel_k<256>(const float*, int, int, const float*, float*, int);
+template void gemm_panel_k<256>(const float*, int, int, const uint16_t*, WeightType, float*, int);
+template void gemm_panel_k<64>(const float*, int, int, const float*, float*, int);
+template void gemm_panel_k<64>(const float*, int, int, const uint16_t*, WeightType, float*, int);
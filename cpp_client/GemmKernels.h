@@ -0,0 +1,55 @@
+#pragma once
+
+#include "LstmKernels.h"
+
+// Columns of one packed LSTM tile panel: four gates of kPackTile units each
+constexpr int kPanelWidth = 4 * kPackTile;
+
+// The microkernel uses intrinsics when built for AVX-512 or AVX2 + FMA. kGemmRows is
+// the rows of A per call: as many as keep the 4 x rows accumulators plus one row of
+// panel registers inside the register file.
+#if defined(__AVX512F__)
+#define EMOTION_GEMM_SIMD 1
+constexpr int kGemmRows = 6;
+#elif defined(__AVX2__) && (defined(__FMA__) || defined(_MSC_VER))
+#define EMOTION_GEMM_SIMD 1
+constexpr int kGemmRows = 3;
+#else
+constexpr int kGemmRows = 4;
+#endif
+
+#ifdef EMOTION_GEMM_SIMD
+constexpr bool kGemmSimd = true;
+#else
+constexpr bool kGemmSimd = false;
+#endif
+
+// 16-bit panels are widened to float32 as they are loaded into registers: bf16 by
+// a 16-bit shift, fp16 with F16C (implied by AVX-512 and by MSVC's /arch:AVX2)
+#if defined(EMOTION_GEMM_SIMD) && (defined(__F16C__) || defined(__AVX512F__) || defined(_MSC_VER))
+#define EMOTION_GEMM_F16 1
+#endif
+
+// Whether the microkernel reads panels of this type at SIMD speed
+constexpr bool gemm_supports(WeightType type) {
+#ifdef EMOTION_GEMM_F16
+    return kGemmSimd || type == WeightType::F32;
+#else
+    return type == WeightType::F32 || (kGemmSimd && type == WeightType::BF16);
+#endif
+}
+
+// c[i][0:kPanelWidth] += sum_r a[i * lda + r] * panel[r][0:kPanelWidth] for i < rows.
+// panel is k rows of one packed tile (see PackedLstm); rows may be anything from 1
+// to kGemmRows, so callers step through A in blocks of kGemmRows.
+void gemm_panel(const float* a, int lda, int rows, int k, const float* panel, float* c, int ldc);
+
+// Same with a panel stored as fp16 or bf16; accumulation is float32
+void gemm_panel(const float* a, int lda, int rows, int k, const uint16_t* panel, WeightType type, float* c, int ldc);
+
+// gemm_panel with k fixed at compile time. Only instantiated for the depths of the
+// specialized LSTM shapes: 300 and 128 (layer 1), 256 and 64 (layer 2).
+template <int K>
+void gemm_panel_k(const float* a, int lda, int rows, const float* panel, float* c, int ldc);
+template <int K>
+void gemm_panel_k(const float* a, int lda, int rows, const uint16_t* panel, WeightType type, float* c, int ldc);
@@ -0,0 +1,88 @@
+#include "HalfFloat.h"
+#include "GemmKernels.h"
+#include <cmath>
+#include <cstring>
+
+#ifdef EMOTION_GEMM_SIMD
+#include <immintrin.h>
+#endif
+
+uint16_t float_to_half(float value) {
+    uint32_t x;
+    std::memcpy(&x, &value, sizeof(x));
+    uint32_t sign = (x >> 16) & 0x8000;
+    uint32_t abs = x & 0x7fffffff;
+    if (abs >= 0x7f800000) return (uint16_t)(sign | (abs > 0x7f800000 ? 0x7e00 : 0x7c00)); // NaN / inf
+    if (abs >= 0x477ff000) return (uint16_t)(sign | 0x7c00);                                 // rounds past 65504
+    if (abs < 0x38800000) {
+        // Subnormal half: scale so the result's units are 2^-24 and let the FPU round
+        float v;
+        std::memcpy(&v, &abs, sizeof(v));
+        return (uint16_t)(sign | (uint32_t)std::nearbyint(v * 16777216.0f));
+    }
+    // Rebias the exponent (127 -> 15) and round the 13 dropped mantissa bits to even
+    abs += 0xc8000fff + ((abs >> 13) & 1);
+    return (uint16_t)(sign | (abs >> 13));
+}
+
+float half_to_float(uint16_t bits) {
+    uint32_t sign = (uint32_t)(bits & 0x8000) << 16;
+    uint32_t exp = (bits >> 10) & 0x1f;
+    uint32_t mant = bits & 0x3ff;
+    uint32_t x;
+    if (exp == 0x1f) {
+        x = sign | 0x7f800000 | (mant << 13);
+    } else if (exp == 0) {
+        float v = mant * (1.0f / 16777216.0f);
+        std::memcpy(&x, &v, sizeof(x));
+        x |= sign;
+    } else {
+        x = sign | ((exp + 112) << 23) | (mant << 13);
+    }
+    float value;
+    std::memcpy(&value, &x, sizeof(value));
+    return value;
+}
+
+uint16_t float_to_bf16(float value) {
+    uint32_t x;
+    std::memcpy(&x, &value, sizeof(x));
+    if ((x & 0x7fffffff) > 0x7f800000) return (uint16_t)((x >> 16) | 0x40); // keep NaN quiet
+    x += 0x7fff + ((x >> 16) & 1);
+    return (uint16_t)(x >> 16);
+}
+
+float bf16_to_float(uint16_t bits) {
+    uint32_t x = (uint32_t)bits << 16;
+    float value;
+    std::memcpy(&value, &x, sizeof(value));
+    return value;
+}
+
+void widen_to_float(const uint16_t* src, WeightType type, int n, float* dst) {
+    int i = 0;
+#ifdef EMOTION_GEMM_F16
+    if (type == WeightType::F16) {
+        for (; i + 8 <= n; i += 8)
+            _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i))));
+    }
+#endif
+#ifdef EMOTION_GEMM_SIMD
+    if (type == WeightType::BF16) {
+        for (; i + 8 <= n; i += 8) {
+            __m256i wide = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)));
+            _mm256_storeu_ps(dst + i, _mm256_castsi256_ps(_mm256_slli_epi32(wide, 16)));
+        }
+    }
+#endif
+    for (; i < n; ++i) dst[i] = type == WeightType::BF16 ? bf16_to_float(src[i]) : half_to_float(src[i]);
+}
+
+const char* weight_type_name(WeightType type) {
+    switch (type) {
+    case WeightType::F32: return "fp32";
+    case WeightType::F16: return "fp16";
+    case WeightType::BF16: return "bf16";
+    default: return "auto";
+    }
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstdint>
+
+// Storage precision of the native engine's large weight matrices. Values are
+// always widened to float32 before use, so every accumulation stays in float32.
+enum class WeightType {
+    Auto, // whatever the model bundle stores
+    F32,
+    F16,  // IEEE half: 10-bit mantissa, range +-65504
+    BF16, // bfloat16: float32 with the low 16 mantissa bits dropped
+};
+
+// Scalar conversions with round-to-nearest-even; used at load time
+uint16_t float_to_half(float value);
+float half_to_float(uint16_t bits);
+uint16_t float_to_bf16(float value);
+float bf16_to_float(uint16_t bits);
+
+// Widen n 16-bit values of the given type into float32 (SIMD when available)
+void widen_to_float(const uint16_t* src, WeightType type, int n, float* dst);
+
+const char* weight_type_name(WeightType type);
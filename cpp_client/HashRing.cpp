@@ -0,0 +1,57 @@
+#include "HashRing.h"
+#include <algorithm>
+
+// 64-bit FNV-1a followed by the splitmix64 finalizer to spread nearby keys
+uint64_t HashRing::hash_bytes(const void* data, size_t len) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    uint64_t h = 1469598103934665603ULL;
+    for (size_t i = 0; i < len; ++i) {
+        h ^= p[i];
+        h *= 1099511628211ULL;
+    }
+    h ^= h >> 30; h *= 0xbf58476d1ce4e5b9ULL;
+    h ^= h >> 27; h *= 0x94d049bb133111ebULL;
+    h ^= h >> 31;
+    return h;
+}
+
+// Insert the node's virtual points; keys only move to or from this node
+void HashRing::add_node(const std::string& node) {
+    if (has_node(node)) return;
+    nodes_.push_back(node);
+    for (int r = 0; r < replicas_; ++r) {
+        std::string vnode = node + "#" + std::to_string(r);
+        ring_[hash_bytes(vnode.data(), vnode.size())] = node;
+    }
+}
+
+// Remove the node's virtual points; its keys fall through to the next node
+void HashRing::remove_node(const std::string& node) {
+    auto it = std::find(nodes_.begin(), nodes_.end(), node);
+    if (it == nodes_.end()) return;
+    nodes_.erase(it);
+    for (auto r = ring_.begin(); r != ring_.end();) {
+        if (r->second == node) r = ring_.erase(r);
+        else ++r;
+    }
+}
+
+bool HashRing::has_node(const std::string& node) const {
+    return std::find(nodes_.begin(), nodes_.end(), node) != nodes_.end();
+}
+
+// Walk clockwise from key collecting distinct owners (primary first, then fallbacks)
+std::vector<std::string> HashRing::lookup(uint64_t key, size_t count) const {
+    std::vector<std::string> out;
+    if (ring_.empty()) return out;
+    count = std::min(count, nodes_.size());
+
+    auto it = ring_.lower_bound(key);
+    for (size_t visited = 0; visited < ring_.size() && out.size() < count; ++visited) {
+        if (it == ring_.end()) it = ring_.begin();
+        if (std::find(out.begin(), out.end(), it->second) == out.end())
+            out.push_back(it->second);
+        ++it;
+    }
+    return out;
+}
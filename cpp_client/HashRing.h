@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+// Consistent-hash ring mapping 64-bit keys to node names, with virtual nodes
+class HashRing {
+public:
+    explicit HashRing(int replicas = 128) : replicas_(replicas) {}
+
+    void add_node(const std::string& node);
+    void remove_node(const std::string& node);
+    bool has_node(const std::string& node) const;
+
+    // Return up to count distinct nodes, walking clockwise from key
+    std::vector<std::string> lookup(uint64_t key, size_t count = 1) const;
+
+    size_t size() const { return nodes_.size(); }
+
+    // 64-bit FNV-1a hash with a final avalanche mix
+    static uint64_t hash_bytes(const void* data, size_t len);
+
+private:
+    int replicas_;
+    std::map<uint64_t, std::string> ring_;
+    std::vector<std::string> nodes_;
+};
@@ -0,0 +1,120 @@
+#include "ImageAtlas.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+// imgui_draw.cpp compiles its own private copy; this one is private to this file too
+#define STBRP_STATIC
+#define STB_RECT_PACK_IMPLEMENTATION
+#include "imstb_rectpack.h"
+
+namespace {
+
+// Border copied from each image's edge pixels, so linear filtering at the edge of a
+// sub-rectangle samples the image itself instead of its neighbour in the atlas
+const int kPadding = 1;
+
+// Largest atlas side tried; every GL 3 implementation supports 8192
+const int kMaxAtlasSize = 8192;
+
+struct Decoded {
+    unsigned char* data = nullptr;
+    int width = 0;
+    int height = 0;
+};
+
+} // namespace
+
+ImageAtlas::~ImageAtlas() {
+    wait();
+}
+
+void ImageAtlas::wait() {
+    if (thread_.joinable()) thread_.join();
+}
+
+void ImageAtlas::load_async(const std::vector<Asset>& images, std::function<void()> on_ready) {
+    sources_ = images;
+    on_ready_ = std::move(on_ready);
+    thread_ = std::thread(&ImageAtlas::build, this);
+}
+
+void ImageAtlas::release_pixels() {
+    pixels_ = std::vector<unsigned char>();
+}
+
+// Decode every image on its own thread, pack the rectangles, then copy the pixels in
+void ImageAtlas::build() {
+    auto start = std::chrono::steady_clock::now();
+    const size_t count = sources_.size();
+    std::vector<Decoded> images(count);
+    std::vector<std::thread> decoders;
+    for (size_t i = 0; i < count; ++i) {
+        decoders.emplace_back([this, &images, i] {
+            int channels;
+            const Asset& source = sources_[i];
+            Decoded& image = images[i];
+            if (source.data)
+                image.data = stbi_load_from_memory(source.data, (int)source.size, &image.width, &image.height, &channels, 4);
+            else
+                image.data = stbi_load(source.path.c_str(), &image.width, &image.height, &channels, 4);
+            if (!image.data) std::cerr << "Failed to load " << (source.data ? source.name : source.path) << std::endl;
+        });
+    }
+    for (std::thread& decoder : decoders) decoder.join();
+
+    // Grow the atlas, alternating sides, until everything fits
+    std::vector<stbrp_rect> rects(count);
+    for (size_t i = 0; i < count; ++i) {
+        rects[i].id = (int)i;
+        rects[i].w = images[i].data ? images[i].width + 2 * kPadding : 0;
+        rects[i].h = images[i].data ? images[i].height + 2 * kPadding : 0;
+    }
+    int width = 256, height = 256;
+    bool packed = false;
+    while (!packed && width <= kMaxAtlasSize && height <= kMaxAtlasSize) {
+        std::vector<stbrp_node> nodes(width);
+        stbrp_context context;
+        stbrp_init_target(&context, width, height, nodes.data(), (int)nodes.size());
+        packed = stbrp_pack_rects(&context, rects.data(), (int)rects.size()) == 1;
+        if (!packed) (width <= height ? width : height) *= 2;
+    }
+
+    regions_.assign(count, Region());
+    if (packed) {
+        width_ = width;
+        height_ = height;
+        pixels_.assign((size_t)width * height * 4, 0);
+        for (const stbrp_rect& rect : rects) {
+            const Decoded& image = images[rect.id];
+            if (!image.data) continue;
+            const size_t row_bytes = (size_t)image.width * 4;
+            for (int y = -kPadding; y < image.height + kPadding; ++y) {
+                const unsigned char* src = &image.data[std::min(std::max(y, 0), image.height - 1) * row_bytes];
+                unsigned char* dst = &pixels_[((size_t)(rect.y + kPadding + y) * width + rect.x) * 4];
+                for (int x = 0; x < kPadding; ++x) {
+                    std::copy_n(src, 4, dst + (size_t)x * 4);
+                    std::copy_n(src + row_bytes - 4, 4, dst + (size_t)(kPadding + image.width + x) * 4);
+                }
+                std::copy_n(src, row_bytes, dst + (size_t)kPadding * 4);
+            }
+            Region& region = regions_[rect.id];
+            region.u0 = (float)(rect.x + kPadding) / width;
+            region.v0 = (float)(rect.y + kPadding) / height;
+            region.u1 = (float)(rect.x + kPadding + image.width) / width;
+            region.v1 = (float)(rect.y + kPadding + image.height) / height;
+            region.width = image.width;
+            region.height = image.height;
+        }
+    } else {
+        std::cerr << "Images do not fit in a " << kMaxAtlasSize << "x" << kMaxAtlasSize << " atlas" << std::endl;
+    }
+    for (Decoded& image : images) stbi_image_free(image.data);
+
+    build_ms_ = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    ready_.store(true, std::memory_order_release);
+    if (on_ready_) on_ready_();
+}
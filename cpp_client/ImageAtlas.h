@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "AssetLocator.h"
+
+// Decodes a set of images on worker threads and packs them into one RGBA8 atlas
+// (imstb_rectpack), so the GUI uploads a single texture and draws each image as a
+// UV sub-rectangle of it instead of switching textures.
+class ImageAtlas {
+public:
+    // Where one image landed, in texture coordinates; width is 0 if it failed to load
+    struct Region {
+        float u0 = 0.0f, v0 = 0.0f, u1 = 0.0f, v1 = 0.0f;
+        int width = 0, height = 0;
+    };
+
+    ImageAtlas() = default;
+    ~ImageAtlas();
+
+    ImageAtlas(const ImageAtlas&) = delete;
+    ImageAtlas& operator=(const ImageAtlas&) = delete;
+
+    // Start decoding and packing images in the background. on_ready, if set, is called on
+    // the background thread once ready() is true.
+    void load_async(const std::vector<Asset>& images, std::function<void()> on_ready = nullptr);
+
+    // True once every image is decoded and packed; the accessors below are valid from then on
+    bool ready() const { return ready_.load(std::memory_order_acquire); }
+
+    // Block until the background work, including on_ready, has finished
+    void wait();
+
+    int width() const { return width_; }
+    int height() const { return height_; }
+    const unsigned char* pixels() const { return pixels_.data(); } // width * height RGBA8, null once released
+    const Region& region(size_t index) const { return regions_[index]; }
+    size_t size() const { return regions_.size(); }
+    double build_ms() const { return build_ms_; } // decode and pack wall time
+
+    // Free the CPU copy of the pixels once they are uploaded
+    void release_pixels();
+
+private:
+    std::vector<Asset> sources_;
+    std::function<void()> on_ready_;
+    std::thread thread_;
+    std::atomic<bool> ready_{false};
+    int width_ = 0;
+    int height_ = 0;
+    std::vector<unsigned char> pixels_;
+    std::vector<Region> regions_;
+    double build_ms_ = 0.0;
+
+    void build();
+};
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+// What an engine remembers between incremental runs of one caller, so the next run can
+// skip the part of the input that did not change. Engines that cannot reuse work leave it empty.
+struct PrefixCache {
+    const void* owner = nullptr; // engine that filled the cache; any other engine starts over
+    std::vector<float> tokens;   // input of the last completed run
+    std::vector<float> h, c;     // engine-specific state per input step
+    std::vector<float> out;      // scores of the last completed run
+};
+
+// Common interface of the TensorFlow and native inference backends
+class InferenceEngine {
+public:
+    virtual ~InferenceEngine() = default;
+
+    // Run a [batch, seq_len] input and write [batch, num_classes] scores into out
+    virtual bool run(const float* input, int batch, int seq_len, std::vector<float>& out) const = 0;
+
+    // Run one [seq_len] input, reusing what cache holds from the caller's previous run.
+    // Returns false without a result if *cancel is set before the run completes; the
+    // default checks it only once, before starting.
+    virtual bool run_incremental(const float* input, int seq_len, PrefixCache& /*cache*/, std::vector<float>& out,
+                                 const std::atomic<bool>* cancel) const {
+        if (cancel && cancel->load()) return false;
+        return run(input, 1, seq_len, out);
+    }
+
+    // True if the engine accepts any seq_len, not only the exported max_len
+    virtual bool dynamic_length() const = 0;
+};
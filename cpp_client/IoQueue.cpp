@@ -0,0 +1,234 @@
+#include "IoQueue.h"
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#endif
+
+namespace {
+
+#ifdef __linux__
+// io_uring through its three syscalls and the shared rings, without liburing. Only one
+// thread submits and reaps, so the ring indices need no more than acquire/release order.
+class UringQueue : public IoQueue {
+public:
+    ~UringQueue() override {
+        if (sqes_ != MAP_FAILED) munmap(sqes_, sqes_size_);
+        if (cq_ring_ != MAP_FAILED && cq_ring_ != sq_ring_) munmap(cq_ring_, cq_ring_size_);
+        if (sq_ring_ != MAP_FAILED) munmap(sq_ring_, sq_ring_size_);
+        if (fd_ >= 0) close(fd_);
+    }
+
+    bool init(unsigned depth, const std::vector<IoBuffer>& buffers) {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        fd_ = (int)syscall(__NR_io_uring_setup, depth, &params);
+        // IORING_FEAT_RW_CUR_POS arrived with IORING_OP_READ/WRITE (5.6), which are used below
+        if (fd_ < 0 || !(params.features & IORING_FEAT_RW_CUR_POS)) return false;
+
+        sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+        if (single_mmap) sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+        sq_ring_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_,
+                        IORING_OFF_SQ_RING);
+        if (sq_ring_ == MAP_FAILED) return false;
+        cq_ring_ = single_mmap ? sq_ring_
+                               : mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                      fd_, IORING_OFF_CQ_RING);
+        if (cq_ring_ == MAP_FAILED) return false;
+        sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+        sqes_ = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQES);
+        if (sqes_ == MAP_FAILED) return false;
+
+        char* sq = static_cast<char*>(sq_ring_);
+        char* cq = static_cast<char*>(cq_ring_);
+        sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sq_mask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sq_array_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cq_mask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+        // Registration can fail on a low RLIMIT_MEMLOCK; plain reads and writes still work
+        if (!buffers.empty()) {
+            std::vector<iovec> iov;
+            for (const IoBuffer& buffer : buffers) iov.push_back({buffer.data, buffer.size});
+            fixed_ = syscall(__NR_io_uring_register, fd_, IORING_REGISTER_BUFFERS, iov.data(), (unsigned)iov.size()) == 0;
+        }
+        return true;
+    }
+
+    const char* name() const override { return "io_uring"; }
+
+    bool submit(const IoRequest& request) override {
+        unsigned tail = *sq_tail_;
+        unsigned index = tail & sq_mask_;
+        io_uring_sqe& sqe = static_cast<io_uring_sqe*>(sqes_)[index];
+        std::memset(&sqe, 0, sizeof(sqe));
+        bool fixed = fixed_ && request.buffer >= 0;
+        if (request.write) sqe.opcode = fixed ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+        else sqe.opcode = fixed ? IORING_OP_READ_FIXED : IORING_OP_READ;
+        sqe.fd = request.fd;
+        sqe.addr = (uint64_t)(uintptr_t)request.data;
+        sqe.len = request.size;
+        sqe.off = request.offset; // kCurrentPosition is io_uring's -1
+        if (fixed) sqe.buf_index = (uint16_t)request.buffer;
+        sqe.user_data = request.tag;
+        sq_array_[index] = index;
+        __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+
+        int submitted;
+        do submitted = enter(1, 0, 0);
+        while (submitted < 0 && errno == EINTR);
+        if (submitted < 0) return false;
+        ++outstanding_;
+        return true;
+    }
+
+    bool wait(IoCompletion& completion) override {
+        if (outstanding_ == 0) return false;
+        for (;;) {
+            unsigned head = *cq_head_;
+            if (head != __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE)) {
+                const io_uring_cqe& cqe = cqes_[head & cq_mask_];
+                completion.tag = cqe.user_data;
+                completion.result = cqe.res;
+                __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+                --outstanding_;
+                return true;
+            }
+            if (enter(0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR) return false;
+        }
+    }
+
+private:
+    int fd_ = -1;
+    void* sq_ring_ = MAP_FAILED;
+    void* cq_ring_ = MAP_FAILED;
+    void* sqes_ = MAP_FAILED;
+    size_t sq_ring_size_ = 0, cq_ring_size_ = 0, sqes_size_ = 0;
+    unsigned* sq_tail_ = nullptr;
+    unsigned* sq_array_ = nullptr;
+    unsigned sq_mask_ = 0;
+    unsigned* cq_head_ = nullptr;
+    unsigned* cq_tail_ = nullptr;
+    unsigned cq_mask_ = 0;
+    io_uring_cqe* cqes_ = nullptr;
+    bool fixed_ = false;
+    unsigned outstanding_ = 0;
+
+    int enter(unsigned to_submit, unsigned min_complete, unsigned flags) {
+        return (int)syscall(__NR_io_uring_enter, fd_, to_submit, min_complete, flags, nullptr, 0);
+    }
+};
+#endif
+
+// One thread per outstanding request, each doing a blocking pread/pwrite
+class ThreadQueue : public IoQueue {
+public:
+    explicit ThreadQueue(unsigned threads) {
+        for (unsigned i = 0; i < threads; ++i) threads_.emplace_back(&ThreadQueue::run, this);
+    }
+
+    ~ThreadQueue() override {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        work_.notify_all();
+        for (std::thread& thread : threads_) thread.join();
+    }
+
+    const char* name() const override { return "threads"; }
+
+    bool submit(const IoRequest& request) override {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            requests_.push_back(request);
+        }
+        ++outstanding_;
+        work_.notify_one();
+        return true;
+    }
+
+    bool wait(IoCompletion& completion) override {
+        if (outstanding_ == 0) return false;
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait(lock, [this] { return !completions_.empty(); });
+        completion = completions_.front();
+        completions_.pop_front();
+        --outstanding_;
+        return true;
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable work_, done_;
+    std::deque<IoRequest> requests_;
+    std::deque<IoCompletion> completions_;
+    std::vector<std::thread> threads_;
+    bool stop_ = false;
+    unsigned outstanding_ = 0; // only touched by the submitting thread
+
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (;;) {
+            work_.wait(lock, [this] { return stop_ || !requests_.empty(); });
+            if (stop_) return;
+            IoRequest request = requests_.front();
+            requests_.pop_front();
+            lock.unlock();
+
+            ssize_t n;
+            do {
+                bool positioned = request.offset != IoRequest::kCurrentPosition;
+                if (request.write)
+                    n = positioned ? pwrite(request.fd, request.data, request.size, (off_t)request.offset)
+                                   : ::write(request.fd, request.data, request.size);
+                else
+                    n = positioned ? pread(request.fd, request.data, request.size, (off_t)request.offset)
+                                   : ::read(request.fd, request.data, request.size);
+            } while (n < 0 && errno == EINTR);
+            int64_t result = n < 0 ? -(int64_t)errno : (int64_t)n;
+
+            lock.lock();
+            completions_.push_back({request.tag, result});
+            done_.notify_one();
+        }
+    }
+};
+
+} // namespace
+
+std::unique_ptr<IoQueue> make_io_queue(unsigned depth, const std::vector<IoBuffer>& buffers, IoBackend backend) {
+#ifdef __linux__
+    if (backend != IoBackend::Threads) {
+        std::unique_ptr<UringQueue> uring(new UringQueue());
+        if (uring->init(depth, buffers)) return uring;
+        if (backend == IoBackend::Uring) return nullptr;
+    }
+#else
+    if (backend == IoBackend::Uring) return nullptr;
+#endif
+    return std::unique_ptr<IoQueue>(new ThreadQueue(depth));
+}
+
+bool parse_io_backend(const std::string& name, IoBackend& backend) {
+    if (name == "auto") backend = IoBackend::Auto;
+    else if (name == "uring") backend = IoBackend::Uring;
+    else if (name == "threads") backend = IoBackend::Threads;
+    else return false;
+    return true;
+}
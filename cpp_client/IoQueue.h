@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Which implementation of IoQueue to use; Auto tries io_uring and falls back to threads
+enum class IoBackend { Auto, Uring, Threads };
+
+// One positioned read or write. offset kCurrentPosition reads or writes at the file's
+// position (pipes, terminals, O_APPEND files); outstanding requests may run in any order,
+// so keep at most one of those in flight per file.
+struct IoRequest {
+    static constexpr uint64_t kCurrentPosition = ~0ULL;
+
+    bool write = false;
+    int fd = -1;
+    char* data = nullptr;
+    uint32_t size = 0;
+    uint64_t offset = 0;
+    int buffer = -1;  // index of a buffer registered with the queue that data points into, or -1
+    uint64_t tag = 0; // returned with the completion
+};
+
+struct IoCompletion {
+    uint64_t tag = 0;
+    int64_t result = 0; // bytes transferred, or -errno
+};
+
+// Asynchronous file I/O: requests are started by submit() and their completions collected,
+// in any order, by wait(). On Linux this is an io_uring driven with raw syscalls (no
+// liburing); where io_uring is missing or blocked, a pool of pread/pwrite threads.
+class IoQueue {
+public:
+    virtual ~IoQueue() = default;
+
+    // "io_uring" or "threads"
+    virtual const char* name() const = 0;
+
+    // Start a request; at most the queue's depth may be outstanding. False on failure.
+    virtual bool submit(const IoRequest& request) = 0;
+
+    // Block until a request completes. False if none is outstanding or the queue failed.
+    virtual bool wait(IoCompletion& completion) = 0;
+};
+
+struct IoBuffer {
+    char* data;
+    size_t size;
+};
+
+// A queue for up to depth outstanding requests. buffers are registered with io_uring, so
+// requests on them skip pinning their pages every time; the thread pool ignores them.
+// nullptr if backend is Uring and io_uring is not available.
+std::unique_ptr<IoQueue> make_io_queue(unsigned depth, const std::vector<IoBuffer>& buffers,
+                                       IoBackend backend = IoBackend::Auto);
+
+// Parse "auto", "uring" or "threads"
+bool parse_io_backend(const std::string& name, IoBackend& backend);
@@ -0,0 +1,82 @@
+#include "LivePredictor.h"
+
+void set_live_result(LivePrediction& prediction, const EmotionClassifier& model, const PredictionResult& result) {
+    prediction.model_id = model.id();
+    prediction.labels = model.labels();
+    prediction.result = result;
+    prediction.result.label = {}; // points into model, which may be gone before the result
+}
+
+LivePredictor::LivePredictor(const ClassifierHost& host, std::chrono::milliseconds debounce,
+                             std::function<void()> on_result)
+    : host_(host), debounce_(debounce), on_result_(std::move(on_result)), thread_(&LivePredictor::loop, this) {}
+
+LivePredictor::~LivePredictor() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    cancel_ = true;
+    wake_.notify_one();
+    thread_.join();
+}
+
+void LivePredictor::submit(const std::string& text) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        text_ = text;
+        ++generation_;
+        pending_ = true;
+        last_edit_ = std::chrono::steady_clock::now();
+    }
+    cancel_ = true; // the running prediction, if any, is for older text
+    wake_.notify_one();
+}
+
+bool LivePredictor::poll(LivePrediction& result) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!fresh_) return false;
+    result = latest_;
+    fresh_ = false;
+    return true;
+}
+
+void LivePredictor::loop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        wake_.wait(lock, [this] { return stop_ || pending_; });
+        if (stop_) return;
+
+        // Debounce: start only once no edit has arrived for debounce_
+        auto deadline = last_edit_ + debounce_;
+        if (wake_.wait_until(lock, deadline, [&] { return stop_ || last_edit_ + debounce_ > deadline; }))
+            continue;
+
+        LivePrediction prediction;
+        prediction.generation = generation_;
+        prediction.text = text_;
+        pending_ = false;
+        cancel_ = false;
+        lock.unlock();
+
+        // Keep the cache only while the same model serves; a hot reload starts it over. The
+        // model is only held for the run, so a reload never waits for the next edit.
+        if (std::shared_ptr<const EmotionClassifier> classifier = host_.acquire()) {
+            if (classifier->id() != cache_model_) {
+                cache_model_ = classifier->id();
+                cache_ = PrefixCache();
+            }
+            if (!prediction.text.empty())
+                set_live_result(prediction, *classifier,
+                                classifier->predict_incremental(prediction.text, cache_, &cancel_));
+        }
+
+        lock.lock();
+        // A cancelled or superseded run has nothing to show; the newer request follows
+        if (prediction.result.ok() && prediction.generation == generation_) {
+            latest_ = std::move(prediction);
+            fresh_ = true;
+            if (on_result_) on_result_();
+        }
+    }
+}
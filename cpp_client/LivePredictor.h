@@ -0,0 +1,73 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ClassifierHost.h"
+
+// One finished prediction. It holds copies of what it needs from the model, so the model
+// can be released (and a hot reload finish) while the prediction is still on screen.
+struct LivePrediction {
+    uint64_t generation = 0;         // submit() call it answers
+    std::string text;
+    uint64_t model_id = 0;           // EmotionClassifier::id() of the model that answered, 0 if none
+    std::vector<std::string> labels; // that model's labels, indexed by class id
+    PredictionResult result;         // result.label is left empty: use label()
+
+    const std::string& label() const { return labels[result.class_id]; }
+};
+
+// Fill a LivePrediction's result and model fields from model's answer
+void set_live_result(LivePrediction& prediction, const EmotionClassifier& model, const PredictionResult& result);
+
+// Predicts on a background thread while the user types. submit() is cheap enough to
+// call on every edit: the worker waits until the text has been unchanged for the
+// debounce delay, and an edit that arrives while a prediction runs cancels it.
+// Consecutive texts share a prefix cache, so appending a word re-runs only the new steps.
+class LivePredictor {
+public:
+    // on_result, if set, is called on the worker thread whenever poll() has something new
+    explicit LivePredictor(const ClassifierHost& host,
+                           std::chrono::milliseconds debounce = std::chrono::milliseconds(150),
+                           std::function<void()> on_result = nullptr);
+    ~LivePredictor();
+
+    LivePredictor(const LivePredictor&) = delete;
+    LivePredictor& operator=(const LivePredictor&) = delete;
+
+    // Ask for a prediction of text, superseding any earlier request
+    void submit(const std::string& text);
+
+    // Copy the newest finished prediction into result; false if there is nothing new
+    bool poll(LivePrediction& result);
+
+private:
+    const ClassifierHost& host_;
+    std::chrono::milliseconds debounce_;
+    std::function<void()> on_result_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::string text_;
+    uint64_t generation_ = 0;
+    bool pending_ = false;
+    bool stop_ = false;
+    std::chrono::steady_clock::time_point last_edit_;
+    std::atomic<bool> cancel_{false};
+    LivePrediction latest_;
+    bool fresh_ = false;
+
+    // Worker-only state
+    uint64_t cache_model_ = 0; // EmotionClassifier::id() of the model cache_ belongs to
+    PrefixCache cache_;
+    std::thread thread_;
+
+    void loop();
+};
@@ -0,0 +1,136 @@
+#include "LogFollower.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <thread>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#endif
+
+LogFollower::LogFollower(std::string path, uint64_t offset, uint64_t inode)
+    : path_(std::move(path)), inode_(inode), offset_(offset), buffer_(kReadSize) {
+#ifdef __linux__
+    // Watch the directory rather than the file: it reports appends to the file as well as
+    // a new file appearing under its name
+    std::string dir = std::filesystem::path(path_).parent_path().string();
+    notify_fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (notify_fd_ >= 0 &&
+        inotify_add_watch(notify_fd_, dir.empty() ? "." : dir.c_str(), IN_MODIFY | IN_CREATE | IN_MOVED_TO) < 0) {
+        close(notify_fd_);
+        notify_fd_ = -1;
+    }
+    if (notify_fd_ < 0) std::cerr << "[FOLLOW] inotify unavailable, checking " << path_ << " periodically" << std::endl;
+#endif
+    if (!open_file()) std::cerr << "[FOLLOW] waiting for " << path_ << " to appear" << std::endl;
+}
+
+LogFollower::~LogFollower() {
+    if (fd_ >= 0) close(fd_);
+    if (notify_fd_ >= 0) close(notify_fd_);
+}
+
+// Open path_, starting over at 0 unless it is the file offset_ belongs to
+bool LogFollower::open_file() {
+    int fd = ::open(path_.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    struct stat st;
+    fstat(fd, &st);
+    if (inode_ != 0 && (uint64_t)st.st_ino != inode_ && offset_ != 0) {
+        std::cerr << "[FOLLOW] " << path_ << " is a different file than last time; reading it from the start" << std::endl;
+        offset_ = 0;
+    }
+    inode_ = (uint64_t)st.st_ino;
+    if (fd_ >= 0) close(fd_);
+    fd_ = fd;
+    partial_.clear();
+    return true;
+}
+
+// At the end of the data: start over if the file shrank, or switch to a new file put in
+// its place. Returns true if reading should continue from the start of a file.
+bool LogFollower::check_replaced() {
+    struct stat open_st, path_st;
+    if (fstat(fd_, &open_st) == 0 && (uint64_t)open_st.st_size < offset_ + partial_.size()) {
+        std::cerr << "[FOLLOW] " << path_ << " was truncated; reading it from the start" << std::endl;
+        offset_ = 0;
+        partial_.clear();
+        return true;
+    }
+    if (stat(path_.c_str(), &path_st) == 0 && path_st.st_ino != open_st.st_ino) {
+        // Rotated: everything in the old file has been read
+        if (!partial_.empty())
+            std::cerr << "[FOLLOW] rotated file ended without a line break; dropped " << partial_.size() << " bytes"
+                      << std::endl;
+        offset_ = 0;
+        inode_ = 0;
+        return open_file();
+    }
+    return false;
+}
+
+// Sleep until the directory reports a change or timeout_ms passes
+void LogFollower::wait(int timeout_ms) {
+#ifdef __linux__
+    if (notify_fd_ >= 0) {
+        pollfd pfd = {notify_fd_, POLLIN, 0};
+        if (::poll(&pfd, 1, timeout_ms) > 0) {
+            alignas(inotify_event) char events[4096];
+            while (read(notify_fd_, events, sizeof(events)) > 0) {} // only the wake-up matters
+        }
+        return;
+    }
+#endif
+    int sleep_ms = timeout_ms < 0 ? 200 : std::min(timeout_ms, 200);
+    std::this_thread::sleep_for(std::chrono::milliseconds(sleep_ms));
+}
+
+// One pread past the last complete line; cut what arrived into lines
+bool LogFollower::read_some(std::vector<Line>& lines) {
+    if (fd_ < 0 && !open_file()) return true; // not there yet
+    ssize_t n = ::pread(fd_, buffer_.data(), buffer_.size(), (off_t)(offset_ + partial_.size()));
+    if (n < 0) {
+        if (errno == EINTR) return true;
+        std::cerr << "ERROR: cannot read " << path_ << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    more_ = (size_t)n == buffer_.size();
+    if (n == 0) {
+        if (check_replaced()) more_ = true;
+        return true;
+    }
+    const char* p = buffer_.data();
+    const char* end = p + n;
+    while (p < end) {
+        const char* newline = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        if (!newline) {
+            partial_.append(p, end);
+            break;
+        }
+        Line line;
+        line.text.swap(partial_);
+        line.text.append(p, newline);
+        offset_ += line.text.size() + 1;
+        line.end = offset_;
+        if (!line.text.empty() && line.text.back() == '\r') line.text.pop_back();
+        lines.push_back(std::move(line));
+        p = newline + 1;
+    }
+    return true;
+}
+
+bool LogFollower::poll(std::vector<Line>& lines, int timeout_ms) {
+    size_t count = lines.size();
+    if (!read_some(lines)) return false;
+    if (lines.size() > count || more_) return true;
+    wait(timeout_ms);
+    return read_some(lines);
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Follows a file that is being appended to, like tail -f. Only bytes after the last
+// complete line are ever read (pread from the saved offset), and on Linux inotify wakes
+// the reader as soon as something is written instead of it polling the file.
+// A truncated file is read again from the start, and a file replaced under the same
+// path (log rotation) is reopened.
+class LogFollower {
+public:
+    struct Line {
+        std::string text;    // without the line break
+        uint64_t end = 0;    // offset just past the line break
+    };
+
+    // Start at offset, which must be the start of a line; inode, if not 0, is the file the
+    // offset belongs to, so a file that has since been replaced is read from the start
+    LogFollower(std::string path, uint64_t offset = 0, uint64_t inode = 0);
+    ~LogFollower();
+
+    LogFollower(const LogFollower&) = delete;
+    LogFollower& operator=(const LogFollower&) = delete;
+
+    // Append the complete lines written since the last call to lines. If there are none,
+    // wait up to timeout_ms for more (an interrupting signal ends the wait early). At
+    // most one read's worth of data is consumed per call. False if the file cannot be read.
+    bool poll(std::vector<Line>& lines, int timeout_ms);
+
+    // Offset just past the last line handed out, and the file it belongs to
+    uint64_t offset() const { return offset_; }
+    uint64_t inode() const { return inode_; }
+
+private:
+    static constexpr size_t kReadSize = 1 << 20;
+
+    std::string path_;
+    int fd_ = -1;
+    int notify_fd_ = -1;
+    uint64_t inode_ = 0;
+    uint64_t offset_ = 0;
+    std::string partial_; // bytes after offset_ that do not end in a line break yet
+    std::vector<char> buffer_;
+    bool more_ = false;   // the last read filled the buffer, so do not wait before the next
+
+    bool open_file();
+    bool check_replaced();
+    bool read_some(std::vector<Line>& lines);
+    void wait(int timeout_ms);
+};
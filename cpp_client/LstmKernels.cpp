@@ -0,0 +1,233 @@
+#include "LstmKernels.h"
+#include "GemmKernels.h"
+#include "ScratchArena.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+inline float sigmoid(float x) {
+    return 1.0f / (1.0f + std::exp(-x));
+}
+
+constexpr int tiles_for(int units) {
+    return (units + kPackTile - 1) / kPackTile;
+}
+
+// Fused epilogue: gate nonlinearities and the c/h update for one tile.
+// acc holds the i, f, c and o pre-activations, kPackTile lanes each.
+inline void tile_cell_update(const float* acc, float* c, float* h_next) {
+    const float* ig = acc;
+    const float* fg = acc + kPackTile;
+    const float* cg = acc + 2 * kPackTile;
+    const float* og = acc + 3 * kPackTile;
+    for (int l = 0; l < kPackTile; ++l) {
+        float cl = sigmoid(fg[l]) * c[l] + sigmoid(ig[l]) * std::tanh(cg[l]);
+        c[l] = cl;
+        h_next[l] = sigmoid(og[l]) * std::tanh(cl);
+    }
+}
+
+} // namespace
+
+// Keras [rows, 4*units] (gates i, f, c, o) -> [tile][row][gate][lane]
+PackedLstm pack_lstm(const LstmWeights& w) {
+    PackedLstm p;
+    p.input_dim = w.input_dim;
+    p.units = w.units;
+    p.tiles = tiles_for(w.units);
+    const int rows = w.input_dim + w.units;
+    const int n = 4 * w.units;
+    p.panels.assign((size_t)p.tiles * rows * 4 * kPackTile, 0.0f);
+    p.bias.assign((size_t)p.tiles * 4 * kPackTile, 0.0f);
+
+    for (int u = 0; u < w.units; ++u) {
+        int tile = u / kPackTile, lane = u % kPackTile;
+        for (int g = 0; g < 4; ++g) {
+            int col = g * w.units + u;
+            p.bias[(size_t)(tile * 4 + g) * kPackTile + lane] = w.bias[col];
+            for (int r = 0; r < rows; ++r) {
+                float v = r < w.input_dim ? w.kernel[(size_t)r * n + col]
+                                          : w.recurrent[(size_t)(r - w.input_dim) * n + col];
+                p.panels[(((size_t)tile * rows + r) * 4 + g) * kPackTile + lane] = v;
+            }
+        }
+    }
+    return p;
+}
+
+void narrow_lstm(PackedLstm& packed, WeightType type) {
+    if (type != WeightType::F16 && type != WeightType::BF16) return;
+    packed.panels16.resize(packed.panels.size());
+    for (size_t i = 0; i < packed.panels.size(); ++i)
+        packed.panels16[i] = type == WeightType::BF16 ? float_to_bf16(packed.panels[i]) : float_to_half(packed.panels[i]);
+    packed.panels = std::vector<float>();
+    packed.type = type;
+}
+
+// [input_dim, units] -> [tile][row][lane]
+PackedDense pack_dense(int input_dim, int units, const std::vector<float>& kernel, const std::vector<float>& bias) {
+    PackedDense d;
+    d.input_dim = input_dim;
+    d.units = units;
+    d.tiles = tiles_for(units);
+    d.panels.assign((size_t)d.tiles * input_dim * kPackTile, 0.0f);
+    d.bias.assign((size_t)d.tiles * kPackTile, 0.0f);
+    for (int u = 0; u < units; ++u) {
+        int tile = u / kPackTile, lane = u % kPackTile;
+        d.bias[(size_t)tile * kPackTile + lane] = bias[u];
+        for (int r = 0; r < input_dim; ++r)
+            d.panels[((size_t)tile * input_dim + r) * kPackTile + lane] = kernel[(size_t)r * units + u];
+    }
+    return d;
+}
+
+// One register-wide accumulator per tile; bias and relu fused into the tile epilogue
+void dense_forward(const PackedDense& d, const float* x, float* out, bool relu) {
+    for (int tile = 0; tile < d.tiles; ++tile) {
+        const float* panel = d.panels.data() + (size_t)tile * d.input_dim * kPackTile;
+        float acc[kPackTile];
+        std::copy(d.bias.data() + tile * kPackTile, d.bias.data() + (tile + 1) * kPackTile, acc);
+        for (int r = 0; r < d.input_dim; ++r) {
+            float v = x[r];
+            if (v == 0.0f) continue; // relu zeros contribute nothing
+            for (int l = 0; l < kPackTile; ++l) acc[l] += v * panel[(size_t)r * kPackTile + l];
+        }
+        int count = std::min(kPackTile, d.units - tile * kPackTile);
+        for (int l = 0; l < count; ++l) out[tile * kPackTile + l] = relu ? std::max(acc[l], 0.0f) : acc[l];
+    }
+}
+
+namespace {
+
+// Panel rows [row, row + k) of one tile, ready for a run of row blocks. 16-bit panels
+// that serve more than one block are widened into scratch once, so the conversion is
+// not repeated per block; a single block widens them in registers instead.
+struct TilePanel {
+    const float* f32 = nullptr;
+    const uint16_t* bits = nullptr;
+    WeightType type;
+
+    TilePanel(const PackedLstm& w, int tile, int row, int k, int blocks, float* scratch) : type(w.type) {
+        size_t offset = ((size_t)tile * (w.input_dim + w.units) + row) * kPanelWidth;
+        if (type == WeightType::F32) {
+            f32 = w.panels.data() + offset;
+        } else if (blocks > 1) {
+            widen_to_float(w.panels16.data() + offset, type, k * kPanelWidth, scratch);
+            f32 = scratch;
+        } else {
+            bits = w.panels16.data() + offset;
+        }
+    }
+
+    // c += a * panel for rows <= kGemmRows rows of a; K > 0 is k fixed at compile time
+    template <int K>
+    void gemm(const float* a, int lda, int rows, int k, float* c, int ldc) const {
+        if constexpr (K > 0) {
+            if (f32) gemm_panel_k<K>(a, lda, rows, f32, c, ldc);
+            else gemm_panel_k<K>(a, lda, rows, bits, type, c, ldc);
+        } else {
+            if (f32) gemm_panel(a, lda, rows, k, f32, c, ldc);
+            else gemm_panel(a, lda, rows, k, bits, type, c, ldc);
+        }
+    }
+};
+
+// The input projection of every (sample, step) is one [batch * steps, input_dim] x
+// [input_dim, 4H] GEMM done up front. The recurrence is then a [batch, H] x [H, 4H]
+// GEMM per step; each tile's recurrent panel is loaded once and reused by every
+// block of kGemmRows samples, and the cell update runs on the block's output.
+// kIn/kUnits > 0 fix the dimensions at compile time, so the GEMM depths, tile count
+// and state copies are constants; <0, 0> reads them from the weights.
+template <int kIn, int kUnits>
+void run_batched_dims(const BatchedDirectionJob& job) {
+    const PackedLstm& w = *job.w;
+    const int in = kIn ? kIn : w.input_dim;
+    const int units = kUnits ? kUnits : w.units;
+    const int tiles = kUnits ? tiles_for(kUnits) : w.tiles;
+    const int gate_cols = tiles * kPanelWidth;
+    const int padded = tiles * kPackTile;
+    const int rows = job.batch * job.steps;
+    ScratchArena::Scope scope;
+    ScratchArena& arena = ScratchArena::local();
+
+    float* xproj = arena.floats((size_t)rows * gate_cols);
+    float* scratch = w.type == WeightType::F32 ? nullptr : arena.floats((size_t)std::max(in, units) * kPanelWidth);
+    const int row_blocks = (rows + kGemmRows - 1) / kGemmRows;
+    for (int tile = 0; tile < tiles; ++tile) {
+        const float* bias = w.bias.data() + tile * kPanelWidth;
+        for (int r = 0; r < rows; ++r)
+            std::copy(bias, bias + kPanelWidth, &xproj[(size_t)r * gate_cols + tile * kPanelWidth]);
+        TilePanel panel(w, tile, 0, in, row_blocks, scratch);
+        for (int r = 0; r < rows; r += kGemmRows)
+            panel.gemm<kIn>(job.x + (size_t)r * in, in, std::min(kGemmRows, rows - r), in,
+                       &xproj[(size_t)r * gate_cols + tile * kPanelWidth], gate_cols);
+    }
+
+    size_t state_size = (size_t)job.batch * padded;
+    float* h = arena.zeros(state_size);
+    float* h_next = arena.zeros(state_size);
+    float* c = arena.zeros(state_size);
+    for (int b = 0; b < job.batch && job.h0; ++b) {
+        std::copy(job.h0 + (size_t)b * units, job.h0 + (size_t)(b + 1) * units, &h[(size_t)b * padded]);
+        std::copy(job.c0 + (size_t)b * units, job.c0 + (size_t)(b + 1) * units, &c[(size_t)b * padded]);
+    }
+    float gates[kGemmRows * kPanelWidth];
+    const int batch_blocks = (job.batch + kGemmRows - 1) / kGemmRows;
+    for (int step = 0; step < job.steps; ++step) {
+        if (job.cancel && job.cancel->load(std::memory_order_relaxed)) return;
+        int t = job.reverse ? job.steps - 1 - step : step;
+        for (int tile = 0; tile < tiles; ++tile) {
+            TilePanel panel(w, tile, in, units, batch_blocks, scratch);
+            for (int b0 = 0; b0 < job.batch; b0 += kGemmRows) {
+                int block = std::min(kGemmRows, job.batch - b0);
+                for (int i = 0; i < block; ++i) {
+                    const float* src = &xproj[((size_t)(b0 + i) * job.steps + t) * gate_cols + tile * kPanelWidth];
+                    std::copy(src, src + kPanelWidth, gates + i * kPanelWidth);
+                }
+                panel.gemm<kUnits>(&h[(size_t)b0 * padded], padded, block, units, gates, kPanelWidth);
+                for (int i = 0; i < block; ++i) {
+                    size_t offset = (size_t)(b0 + i) * padded + tile * kPackTile;
+                    tile_cell_update(gates + i * kPanelWidth, &c[offset], &h_next[offset]);
+                }
+            }
+        }
+        std::swap(h, h_next);
+        if (job.out_seq) {
+            for (int b = 0; b < job.batch; ++b)
+                std::copy(&h[(size_t)b * padded], &h[(size_t)b * padded] + units,
+                          job.out_seq + ((size_t)b * job.steps + t) * job.out_stride);
+        }
+        if (job.out_c) {
+            for (int b = 0; b < job.batch; ++b)
+                std::copy(&c[(size_t)b * padded], &c[(size_t)b * padded] + units,
+                          job.out_c + ((size_t)b * job.steps + t) * units);
+        }
+    }
+    if (job.final_h) {
+        for (int b = 0; b < job.batch; ++b)
+            std::copy(&h[(size_t)b * padded], &h[(size_t)b * padded] + units, job.final_h + (size_t)b * job.final_stride);
+    }
+}
+
+template <int kIn, int kUnits>
+LstmKernel kernel() {
+    return {&run_batched_dims<kIn, kUnits>, kIn != 0};
+}
+
+} // namespace
+
+void run_batched(const BatchedDirectionJob& job) {
+    run_batched_dims<0, 0>(job);
+}
+
+// Shapes of the shipped model: 300-d GloVe into BiLSTM(128), then 2*128 into BiLSTM(64)
+LstmKernel select_lstm_kernel(int input_dim, int units) {
+    if (input_dim == 300 && units == 128) return kernel<300, 128>();
+    if (input_dim == 256 && units == 64) return kernel<256, 64>();
+    return generic_lstm_kernel();
+}
+
+LstmKernel generic_lstm_kernel() {
+    return kernel<0, 0>();
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "HalfFloat.h"
+
+// Hidden units per packed tile: one SIMD register of floats
+#ifdef __AVX512F__
+constexpr int kPackTile = 16;
+#else
+constexpr int kPackTile = 8;
+#endif
+
+// One LSTM direction in Keras layout: gates i, f, c, o along the 4*units axis
+struct LstmWeights {
+    int input_dim = 0;
+    int units = 0;
+    std::vector<float> kernel;    // [input_dim, 4*units]
+    std::vector<float> recurrent; // [units, 4*units]
+    std::vector<float> bias;      // [4*units]
+};
+
+// An LSTM direction repacked at load time so one tile of kPackTile hidden units
+// produces all four gates together. Input and recurrent rows are stacked, so a
+// tile walks one contiguous panel: for each row of [x; h], the i, f, c and o
+// weights of the tile's units follow each other. The cell update then runs on
+// the accumulators directly, without writing the gates out.
+// narrow_lstm can move the panels to 16-bit storage, which run_batched widens as it reads.
+struct PackedLstm {
+    int input_dim = 0;
+    int units = 0;
+    int tiles = 0;                  // ceil(units / kPackTile); padded lanes carry zero weights
+    WeightType type = WeightType::F32;
+    std::vector<float> panels;      // [tiles][input_dim + units][4][kPackTile] when type is F32
+    std::vector<uint16_t> panels16; // same layout as fp16/bf16 bits otherwise
+    std::vector<float> bias;        // [tiles][4][kPackTile], always float32
+};
+
+// Dense layer repacked into kPackTile-wide output panels
+struct PackedDense {
+    int input_dim = 0;
+    int units = 0;
+    int tiles = 0;
+    std::vector<float> panels; // [tiles][input_dim][kPackTile]
+    std::vector<float> bias;   // [tiles][kPackTile]
+};
+
+PackedLstm pack_lstm(const LstmWeights& w);
+
+// Convert float32 panels to fp16 or bf16 storage (rounding to nearest even)
+void narrow_lstm(PackedLstm& packed, WeightType type);
+PackedDense pack_dense(int input_dim, int units, const std::vector<float>& kernel, const std::vector<float>& bias);
+
+// out[0:units] = x * W + b, optionally followed by relu
+void dense_forward(const PackedDense& d, const float* x, float* out, bool relu);
+
+// One direction over a batch of equal-length sequences
+struct BatchedDirectionJob {
+    const PackedLstm* w;
+    const float* x;    // [batch, steps, input_dim]
+    int batch;
+    int steps;
+    bool reverse;
+    float* out_seq;    // h of sample b at step t written at out_seq + (b * steps + t) * out_stride, or null
+    int out_stride;
+    float* final_h;    // last state of sample b written at final_h + b * final_stride, or null
+    int final_stride;
+    const float* h0 = nullptr; // initial h and c of sample b at h0/c0 + b * units; null starts from zeros
+    const float* c0 = nullptr;
+    float* out_c = nullptr;    // c of sample b at step t written at out_c + (b * steps + t) * units, or null
+    const std::atomic<bool>* cancel = nullptr; // checked before every step; the job stops early once set
+};
+
+// Batched direction: hoisted input projection, then one small GEMM per step. A batch of
+// one is the single-sequence path too: hoisting the input projection makes it faster
+// than stepping one sequence through the panels. Dimensions are read at run time.
+void run_batched(const BatchedDirectionJob& job);
+
+using BatchedKernel = void (*)(const BatchedDirectionJob&);
+
+// run_batched for one LSTM shape
+struct LstmKernel {
+    BatchedKernel run;
+    bool specialized; // compiled for these exact dimensions
+};
+
+// run_batched compiled for (input_dim, units) when the shape is one of the model's
+// built-in sizes, otherwise the generic runtime-dimension version
+LstmKernel select_lstm_kernel(int input_dim, int units);
+
+// The generic runtime-dimension run_batched, for any shape
+LstmKernel generic_lstm_kernel();
@@ -0,0 +1,265 @@
+#include "MainWindow.h"
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <utility>
+
+namespace {
+
+void ImGuiTextShadow(const ImVec4& color, const char* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    ImVec2 pos = ImGui::GetCursorScreenPos();
+    ImDrawList* draw_list = ImGui::GetWindowDrawList();
+    char buf[512];
+    vsnprintf(buf, sizeof(buf), fmt, args);
+    va_end(args);
+
+    // Draw shadow (black, slightly offset)
+    draw_list->AddText(ImGui::GetFont(), ImGui::GetFontSize(), ImVec2(pos.x+2, pos.y+2), IM_COL32(0,0,0,180), buf);
+    // Draw main text
+    draw_list->AddText(ImGui::GetFont(), ImGui::GetFontSize(), pos, ImGui::ColorConvertFloat4ToU32(color), buf);
+
+    // Move cursor as if text was drawn
+    ImGui::Dummy(ImGui::CalcTextSize(buf));
+}
+
+// Herta's face for a predicted class (-1 if there is none) of the model with the given
+// EmotionClassifier::id() and labels. The label names are looked up once per model; after
+// that a prediction maps to a face by class id alone. Only the id is remembered, so no
+// model is kept alive here after a reload.
+HertaState state_for_class(uint64_t model_id, const std::vector<std::string>& labels, int class_id) {
+    static uint64_t faces_model = 0;
+    static std::array<HertaState, kMaxClasses> faces;
+    if (model_id == 0 || class_id < 0 || class_id >= (int)labels.size()) return WELCOME;
+    if (model_id != faces_model) {
+        faces_model = model_id;
+        faces.fill(WELCOME);
+        for (size_t i = 0; i < labels.size() && i < faces.size(); ++i) {
+            const std::string& label = labels[i];
+            faces[i] = label == "joy" ? HAPPY : label == "sadness" ? SAD : label == "anger" ? ANGRY
+                     : label == "fear" ? FEAR : WELCOME;
+        }
+    }
+    return faces[class_id];
+}
+
+HertaState state_for_prediction(const LivePrediction& prediction) {
+    return state_for_class(prediction.model_id, prediction.labels,
+                           prediction.result.ok() ? prediction.result.class_id : -1);
+}
+
+// Keeps the std::string behind the text box as long as the text
+int resize_input(ImGuiInputTextCallbackData* data) {
+    if (data->EventFlag == ImGuiInputTextFlags_CallbackResize) {
+        std::string* text = static_cast<std::string*>(data->UserData);
+        text->resize(data->BufTextLen);
+        data->Buf = text->data();
+    }
+    return 0;
+}
+
+} // namespace
+
+MainWindow::MainWindow(const ClassifierHost& host, LivePredictor& live_predictor, BulkAnalyzer& bulk_analyzer)
+    : host_(host), live_predictor_(live_predictor), bulk_analyzer_(bulk_analyzer) {}
+
+MainWindow::~MainWindow() {
+    if (document_thread_.joinable()) document_thread_.join();
+}
+
+void MainWindow::open_bulk(const std::string& path) {
+    bulk_view_.reset();
+    bulk_analyzer_.start(path);
+}
+
+void MainWindow::draw(BackendState backend, const std::string& error) {
+    // Gradient background
+    ImDrawList* draw_list = ImGui::GetBackgroundDrawList();
+    ImVec2 size = ImGui::GetIO().DisplaySize;
+    draw_list->AddRectFilledMultiColor(
+        ImVec2(0, 0), size,
+        IM_COL32(40, 40, 80, 255),   // Top-left color
+        IM_COL32(80, 80, 160, 255),  // Top-right color
+        IM_COL32(30, 30, 60, 255),   // Bottom-right color
+        IM_COL32(10, 10, 30, 255)    // Bottom-left color
+    );
+
+    // Fullscreen window
+    ImVec2 display_size = ImGui::GetIO().DisplaySize;
+    ImGui::SetNextWindowPos(ImVec2(0, 0), ImGuiCond_Always);
+    ImGui::SetNextWindowSize(display_size, ImGuiCond_Always);
+
+    ImGui::PushStyleVar(ImGuiStyleVar_WindowRounding, 18.0f);
+    ImGui::PushStyleColor(ImGuiCol_WindowBg, IM_COL32(30, 30, 40, 220));
+    ImGui::Begin("Emotion Classifier", nullptr, ImGuiWindowFlags_AlwaysAutoResize);
+
+    ImGui::Columns(2, nullptr, false); // 2 columns, no border
+
+    // --- Left column: Herta image ---
+    ImGui::SetColumnWidth(0, 270); // Enough for 256px image + padding
+    draw_herta();
+
+    ImGui::NextColumn();
+
+    // --- Right column: UI ---
+    draw_prediction(backend, error);
+
+    ImGui::Columns(1); // End columns
+
+    // --- Bulk mode: a dropped file, classified line by line ---
+    ImGui::Separator();
+    bulk_view_.draw(bulk_analyzer_);
+
+    ImGui::End();
+    ImGui::PopStyleColor();
+    ImGui::PopStyleVar();
+}
+
+void MainWindow::draw_herta() {
+    float t = animate ? (float)ImGui::GetTime() : 0.0f;
+    float bounce = animate ? 10.0f * sinf(t * 2.5f) : 0.0f;
+    ImVec2 herta_pos = ImGui::GetCursorScreenPos();
+    ImGui::SetCursorScreenPos(ImVec2(herta_pos.x, herta_pos.y + bounce));
+    const ImageAtlas::Region* face = herta_texture ? &herta_atlas->region(herta_state_) : nullptr;
+    if (face && face->width > 0) {
+        ImGui::Image(herta_texture, ImVec2(256, 256), ImVec2(face->u0, face->v0), ImVec2(face->u1, face->v1));
+    } else {
+        // Placeholder while the atlas is still decoding (or if this face failed to load)
+        ImVec2 p = ImGui::GetCursorScreenPos();
+        ImGui::GetWindowDrawList()->AddRectFilled(p, ImVec2(p.x + 256, p.y + 256), IM_COL32(60, 60, 110, 160), 18.0f);
+        ImGui::Dummy(ImVec2(256, 256));
+    }
+    ImGui::SetCursorScreenPos(herta_pos); // Reset for next widgets
+}
+
+void MainWindow::draw_prediction(BackendState backend, const std::string& error) {
+    float t = animate ? (float)ImGui::GetTime() : 0.0f;
+    ImVec4 animatedColor = ImVec4(0.4f + 0.2f*sinf(t*2), 0.7f, 1.0f, 1.0f);
+    ImGuiTextShadow(animatedColor, "Hello, I am Herta!");
+    ImGui::TextWrapped("I was made by Sitanshu and Yash for a semester project.\nKeep in mind that I am just a semester project and I can make mistakes.");
+    ImGui::Separator();
+    ImGui::Spacing();
+
+    ImGui::Text("Enter text for emotion classification:");
+
+    // Clamp input box width to 400px max; documents get a taller box
+    ImVec2 input_box_size = ImVec2(400, document_mode_ ? 200 : 80);
+    ImGui::PushStyleColor(ImGuiCol_FrameBg, IM_COL32(10, 10, 30, 255));
+    ImGui::PushStyleColor(ImGuiCol_Text, IM_COL32(255, 255, 255, 255));
+    if (ImGui::InputTextMultiline("##input", input_.data(), input_.capacity() + 1, input_box_size,
+                                  ImGuiInputTextFlags_CallbackResize, resize_input, &input_)) {
+        if (input_.empty())
+            herta_state_ = WELCOME;
+        else
+            herta_state_ = THINKING;
+        std::shared_ptr<const EmotionClassifier> model = host_.acquire();
+        input_words_ = TextPreprocessor::word_count(input_);
+        input_max_words_ = model ? model->max_len() : ClassifierConfig().max_len;
+    }
+    ImGui::PopStyleColor(2);
+    ImGui::SameLine();
+    if (ImGui::Button("Clear")) {
+        input_.clear();
+        input_words_ = 0;
+        shown_ = LivePrediction();
+        document_view_.clear();
+        herta_state_ = WELCOME;
+    }
+    ImGui::Spacing();
+
+    // Hand every edit to the background predictor (also the pending text once the
+    // model is ready); it debounces, so this costs nothing per keystroke
+    if (backend == BACKEND_READY && !document_mode_ && live_text_ != input_) {
+        live_text_ = input_;
+        live_predictor_.submit(live_text_);
+    }
+    LivePrediction update;
+    if (live_predictor_.poll(update) && update.text == input_ && !document_mode_) {
+        shown_ = std::move(update);
+        herta_state_ = state_for_prediction(shown_);
+    }
+    if (document_job_.valid() && document_job_.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+        document_thread_.join();
+        document_view_.set(document_job_.get(), std::move(document_text_));
+        const DocumentAnalysis& analysis = document_view_.analysis();
+        herta_state_ = state_for_class(analysis.model_id, analysis.labels, analysis.class_id);
+    }
+
+    ImGui::PushFont(custom_font);
+    ImGui::BeginDisabled(backend != BACKEND_READY || document_job_.valid());
+    if (ImGui::Button("Predict", ImVec2(180, 0))) predict();
+    ImGui::EndDisabled();
+    ImGui::SameLine();
+    if (ImGui::IsItemHovered())
+        ImGui::SetTooltip(document_mode_ ? "Click to classify every sentence of the entered text."
+                                         : "Click to predict the emotion of the entered text.");
+    ImGui::PopFont();
+    ImGui::SameLine();
+    ImGui::Checkbox("Animate", &animate);
+    ImGui::SameLine();
+    ImGui::Checkbox("Document", &document_mode_);
+
+    ImGui::Spacing();
+
+    if (!document_mode_ && input_words_ > input_max_words_)
+        ImGui::TextDisabled("Only the first %d of %d words are read. Tick Document to classify every sentence.",
+                            input_max_words_, input_words_);
+
+    if (backend == BACKEND_LOADING) {
+        ImGui::TextDisabled("Herta is waking up (loading the model)...");
+    } else if (backend == BACKEND_FAILED) {
+        ImGui::PushStyleColor(ImGuiCol_Text, IM_COL32(255, 80, 80, 255));
+        ImGui::TextWrapped("%s", error.c_str());
+        ImGui::PopStyleColor();
+    }
+
+    if (document_mode_) {
+        if (document_job_.valid()) ImGui::TextDisabled("Herta is reading the document...");
+        document_view_.draw();
+    } else if (shown_.model_id && !shown_.result.ok()) {
+        ImGuiTextShadow(ImVec4(1.0f, 0.2f, 0.2f, 1.0f), "Prediction failed, please try again.");
+    } else if (shown_.model_id) {
+        const PredictionResult& r = shown_.result;
+        ImGuiTextShadow(ImVec4(0.2f, 0.8f, 0.2f, 1.0f), "Predicted emotion: %s (%.0f%%)", shown_.label().c_str(),
+                        100.0f * r.confidence());
+
+        // Per-emotion probabilities while they still describe the text in the box
+        if (shown_.text == input_) {
+            for (int i = 0; i < r.num_classes; ++i) {
+                char overlay[64];
+                snprintf(overlay, sizeof(overlay), "%s %.0f%%", shown_.labels[i].c_str(), 100.0f * r.probs[i]);
+                ImGui::ProgressBar(r.probs[i], ImVec2(400, 0), overlay);
+            }
+            ImGui::TextDisabled("%.1f ms", (r.timings.preprocess_us + r.timings.inference_us +
+                                            r.timings.postprocess_us) / 1000.0f);
+        }
+    }
+}
+
+void MainWindow::predict() {
+    std::shared_ptr<const EmotionClassifier> model = host_.acquire();
+    if (!document_mode_) {
+        // Classify with the currently active, warmed-up classifier
+        shown_ = LivePrediction();
+        shown_.text = input_;
+        set_live_result(shown_, *model, model->predict(shown_.text));
+        herta_state_ = state_for_prediction(shown_);
+        return;
+    }
+
+    // Split and classify the document on a worker thread; draw() picks up the result
+    std::promise<DocumentAnalysis> promise;
+    document_job_ = promise.get_future();
+    document_text_ = input_;
+    herta_state_ = THINKING;
+    document_thread_ = std::thread([this, model, text = input_, promise = std::move(promise)]() mutable {
+        promise.set_value(analyze_document(model, text));
+        if (on_result) on_result();
+    });
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <functional>
+#include <future>
+#include <string>
+#include <thread>
+
+#include "imgui.h"
+#include "BulkResultsView.h"
+#include "DocumentView.h"
+#include "ImageAtlas.h"
+#include "LivePredictor.h"
+
+// TensorFlow and the model are loaded and warmed up on a background thread once the first frame is up
+enum BackendState { BACKEND_LOADING, BACKEND_READY, BACKEND_FAILED };
+
+// Herta's faces, in the order of the images in her atlas
+enum HertaState { WELCOME, THINKING, HAPPY, SAD, ANGRY, FEAR };
+
+// The client's whole UI: Herta, the text box with its live prediction (or, in document
+// mode, its per-sentence analysis), and the bulk results table. It only builds ImGui widgets, so gui_main draws it between NewFrame and
+// Render with GLFW and OpenGL, and bench_ui drives it headless with synthetic input.
+class MainWindow {
+public:
+    MainWindow(const ClassifierHost& host, LivePredictor& live_predictor, BulkAnalyzer& bulk_analyzer);
+    ~MainWindow();
+
+    MainWindow(const MainWindow&) = delete;
+    MainWindow& operator=(const MainWindow&) = delete;
+
+    ImFont* custom_font = nullptr;            // Predict button font; the default font if null
+    ImTextureID herta_texture = 0;            // the uploaded herta_atlas, 0 until then
+    const ImageAtlas* herta_atlas = nullptr;
+    bool animate = true;                      // Herta's bounce and the title color
+    std::function<void()> on_result;          // called on a worker thread when a document analysis is done
+
+    // Start classifying a dropped file into the results table
+    void open_bulk(const std::string& path);
+
+    // Build this frame's widgets; error is shown while backend is BACKEND_FAILED
+    void draw(BackendState backend, const std::string& error);
+
+    // The prediction on screen; model is null if there is none
+    const LivePrediction& prediction() const { return shown_; }
+
+private:
+    const ClassifierHost& host_;
+    LivePredictor& live_predictor_;
+    BulkAnalyzer& bulk_analyzer_;
+    BulkResultsView bulk_view_;
+
+    std::string input_;       // grows with the text box (ImGuiInputTextFlags_CallbackResize)
+    int input_words_ = 0;     // words in input_; the model reads the first input_max_words_
+    int input_max_words_ = 0;
+    LivePrediction shown_;    // prediction on screen, from the button or as-you-type
+    std::string live_text_;   // last text handed to live_predictor_
+    HertaState herta_state_ = WELCOME;
+
+    // Document mode: long texts are classified sentence by sentence in the background
+    bool document_mode_ = false;
+    std::future<DocumentAnalysis> document_job_; // valid while an analysis is running
+    std::thread document_thread_;
+    std::string document_text_; // the text document_job_ is analyzing
+    DocumentView document_view_;
+
+    void draw_herta();
+    void draw_prediction(BackendState backend, const std::string& error);
+    void predict();
+};
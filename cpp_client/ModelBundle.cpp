@@ -0,0 +1,60 @@
+#include "ModelBundle.h"
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+static bool read_u32(std::ifstream& in, uint32_t& value) {
+    return (bool)in.read(reinterpret_cast<char*>(&value), sizeof(value));
+}
+
+// Parse the bundle header and tensor table
+bool ModelBundle::load(const std::string& path) {
+    tensors_.clear();
+    std::ifstream in(path, std::ios::binary);
+    char magic[4];
+    uint32_t version = 0, count = 0;
+    if (!in.read(magic, 4) || std::memcmp(magic, "EMOB", 4) != 0 || !read_u32(in, version) || version != 1 ||
+        !read_u32(in, count)) {
+        std::cerr << "ERROR: " << path << " is not a model bundle" << std::endl;
+        return false;
+    }
+
+    for (uint32_t i = 0; i < count; ++i) {
+        uint32_t name_len = 0, rank = 0, dtype = 0;
+        if (!read_u32(in, name_len) || name_len > 256) break;
+        std::string name(name_len, '\0');
+        if (!in.read(&name[0], name_len) || !read_u32(in, rank) || rank > 4) break;
+
+        BundleTensor tensor;
+        size_t elements = 1;
+        for (uint32_t d = 0; d < rank; ++d) {
+            uint32_t dim = 0;
+            if (!read_u32(in, dim)) break;
+            tensor.dims.push_back((int)dim);
+            elements *= dim;
+        }
+        if (tensor.dims.size() != rank || !read_u32(in, dtype) || dtype > 2) break;
+
+        tensor.data.resize(elements);
+        if (dtype == 0) {
+            if (!in.read(reinterpret_cast<char*>(tensor.data.data()), elements * sizeof(float))) break;
+        } else {
+            tensor.stored = dtype == 1 ? WeightType::F16 : WeightType::BF16;
+            std::vector<uint16_t> bits(elements);
+            if (!in.read(reinterpret_cast<char*>(bits.data()), elements * sizeof(uint16_t))) break;
+            widen_to_float(bits.data(), tensor.stored, (int)elements, tensor.data.data());
+        }
+        tensors_[name] = std::move(tensor);
+    }
+    if (tensors_.size() != count) {
+        std::cerr << "ERROR: model bundle " << path << " is truncated or corrupt" << std::endl;
+        tensors_.clear();
+        return false;
+    }
+    return true;
+}
+
+const BundleTensor* ModelBundle::find(const std::string& name) const {
+    auto it = tensors_.find(name);
+    return it == tensors_.end() ? nullptr : &it->second;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "HalfFloat.h"
+
+// A named tensor read from a model bundle, widened to float32
+struct BundleTensor {
+    std::vector<int> dims;
+    std::vector<float> data;
+    WeightType stored = WeightType::F32; // precision in the file
+};
+
+// Weights exported by export_bundle.py for the native engine.
+// File layout (little-endian): "EMOB", u32 version, u32 tensor count, then per tensor:
+// u32 name length, name bytes, u32 rank, u32 dims[rank], u32 dtype (0 = float32,
+// 1 = float16, 2 = bfloat16), raw data.
+class ModelBundle {
+public:
+    // Read every tensor from path; logs and returns false on malformed input
+    bool load(const std::string& path);
+
+    // Tensor by name, or null if absent
+    const BundleTensor* find(const std::string& name) const;
+
+private:
+    std::map<std::string, BundleTensor> tensors_;
+};
@@ -0,0 +1,310 @@
+#include "NativeEngine.h"
+#include "GemmKernels.h"
+#include "ScratchArena.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+// Sequences per batched forward pass
+const int kBatchBlock = 64;
+
+// Copy a bundle tensor into dst after checking its shape
+bool take(const ModelBundle& bundle, const std::string& name, const std::vector<int>& dims, std::vector<float>& dst) {
+    const BundleTensor* t = bundle.find(name);
+    if (!t || t->dims != dims) {
+        std::cerr << "ERROR: model bundle tensor " << name << " is missing or has the wrong shape" << std::endl;
+        return false;
+    }
+    dst = t->data;
+    return true;
+}
+
+// Read one LSTM direction in Keras layout and repack it; the Keras copy is dropped
+bool load_lstm(const ModelBundle& bundle, const std::string& prefix, int input_dim, PackedLstm& packed) {
+    const BundleTensor* r = bundle.find(prefix + "_recurrent");
+    if (!r || r->dims.size() != 2) {
+        std::cerr << "ERROR: model bundle is missing " << prefix << "_recurrent" << std::endl;
+        return false;
+    }
+    LstmWeights w;
+    w.input_dim = input_dim;
+    w.units = r->dims[0];
+    int n = 4 * w.units;
+    if (!take(bundle, prefix + "_kernel", {input_dim, n}, w.kernel) ||
+        !take(bundle, prefix + "_recurrent", {w.units, n}, w.recurrent) ||
+        !take(bundle, prefix + "_bias", {n}, w.bias))
+        return false;
+    packed = pack_lstm(w);
+    return true;
+}
+
+bool load_dense(const ModelBundle& bundle, const std::string& prefix, int input_dim, PackedDense& packed) {
+    const BundleTensor* b = bundle.find(prefix + "_bias");
+    if (!b || b->dims.size() != 1) {
+        std::cerr << "ERROR: model bundle is missing " << prefix << "_bias" << std::endl;
+        return false;
+    }
+    int units = b->dims[0];
+    std::vector<float> kernel, bias;
+    if (!take(bundle, prefix + "_kernel", {input_dim, units}, kernel) ||
+        !take(bundle, prefix + "_bias", {units}, bias))
+        return false;
+    packed = pack_dense(input_dim, units, kernel, bias);
+    return true;
+}
+
+const char* mode_name(DirectionMode mode) {
+    switch (mode) {
+    case DirectionMode::Sequential: return "sequential";
+    case DirectionMode::Threaded: return "threaded";
+    default: return "auto";
+    }
+}
+
+} // namespace
+
+// Read and validate every layer, then settle the direction mode
+bool NativeEngine::load(const std::string& bundle_path) {
+    ModelBundle bundle;
+    if (!bundle.load(bundle_path)) return false;
+
+    const BundleTensor* emb = bundle.find("embedding");
+    if (!emb || emb->dims.size() != 2) {
+        std::cerr << "ERROR: model bundle is missing the embedding matrix" << std::endl;
+        return false;
+    }
+    vocab_size_ = emb->dims[0];
+    embedding_dim_ = emb->dims[1];
+
+    if (!load_lstm(bundle, "lstm1_fw", embedding_dim_, lstm1_.fw) ||
+        !load_lstm(bundle, "lstm1_bw", embedding_dim_, lstm1_.bw) ||
+        !load_lstm(bundle, "lstm2_fw", 2 * lstm1_.fw.units, lstm2_.fw) ||
+        !load_lstm(bundle, "lstm2_bw", 2 * lstm1_.fw.units, lstm2_.bw) ||
+        !load_dense(bundle, "dense1", 2 * lstm2_.fw.units, dense1_) ||
+        !load_dense(bundle, "dense2", dense1_.units, dense2_))
+        return false;
+    if (lstm1_.fw.units != lstm1_.bw.units || lstm2_.fw.units != lstm2_.bw.units) {
+        std::cerr << "ERROR: model bundle has mismatched forward/backward LSTM sizes" << std::endl;
+        return false;
+    }
+
+    // 16-bit weights halve the bytes streamed per step; they are widened in registers
+    if (weights_ == WeightType::Auto) weights_ = emb->stored;
+    if (!gemm_supports(weights_)) {
+        std::cerr << "[NATIVE] " << weight_type_name(weights_) << " weights need an AVX2/F16C build, using fp32"
+                  << std::endl;
+        weights_ = WeightType::F32;
+    }
+    if (weights_ == WeightType::F32) {
+        embedding_ = emb->data;
+    } else {
+        embedding16_.resize(emb->data.size());
+        for (size_t i = 0; i < emb->data.size(); ++i)
+            embedding16_[i] = weights_ == WeightType::BF16 ? float_to_bf16(emb->data[i]) : float_to_half(emb->data[i]);
+        for (PackedLstm* w : {&lstm1_.fw, &lstm1_.bw, &lstm2_.fw, &lstm2_.bw}) narrow_lstm(*w, weights_);
+    }
+
+    lstm1_.kernel = select_lstm_kernel(lstm1_.fw.input_dim, lstm1_.fw.units);
+    lstm2_.kernel = select_lstm_kernel(lstm2_.fw.input_dim, lstm2_.fw.units);
+
+    if (std::thread::hardware_concurrency() > 1 &&
+        (mode_ == DirectionMode::Auto || mode_ == DirectionMode::Threaded))
+        worker_.reset(new DirectionWorker());
+    if (mode_ == DirectionMode::Threaded && !worker_) mode_ = DirectionMode::Sequential;
+    if (mode_ == DirectionMode::Auto) calibrate();
+    std::cerr << "[NATIVE] loaded " << bundle_path << ", directions: " << mode_name(mode_)
+              << ", weights: " << weight_type_name(weights_) << " (" << weight_bytes() / (1 << 20) << " MB)"
+              << ", kernels: batched gemm" << (kGemmSimd ? "" : " (portable)") << ", "
+              << (lstm1_.kernel.specialized && lstm2_.kernel.specialized ? "specialized" : "generic") << std::endl;
+    return true;
+}
+
+size_t NativeEngine::weight_bytes() const {
+    size_t bytes = embedding_.size() * sizeof(float) + embedding16_.size() * sizeof(uint16_t);
+    for (const PackedLstm* w : {&lstm1_.fw, &lstm1_.bw, &lstm2_.fw, &lstm2_.bw})
+        bytes += w->panels.size() * sizeof(float) + w->panels16.size() * sizeof(uint16_t) + w->bias.size() * sizeof(float);
+    return bytes;
+}
+
+// The arena is thread-local, so the helper reads its own capacity
+size_t NativeEngine::helper_arena_capacity() const {
+    if (!worker_ || !worker_->try_acquire()) return 0;
+    size_t capacity = 0;
+    worker_->post([](void* p) { *static_cast<size_t*>(p) = ScratchArena::local().capacity(); }, &capacity);
+    worker_->wait();
+    worker_->release();
+    return capacity;
+}
+
+// Time batch-1 forward passes in every available mode and keep the fastest
+void NativeEngine::calibrate() {
+    std::vector<float> tokens(100, 0.0f);
+    for (int t = 0; t < 20; ++t) tokens[t] = (float)(1 + t % std::max(1, vocab_size_ - 1));
+    std::vector<float> probs(dense2_.units);
+
+    std::vector<DirectionMode> candidates = {DirectionMode::Sequential};
+    if (worker_) candidates.push_back(DirectionMode::Threaded);
+
+    DirectionMode best = DirectionMode::Sequential;
+    double best_us = 1e30;
+    for (DirectionMode mode : candidates) {
+        forward_block(tokens.data(), 1, (int)tokens.size(), probs.data(), mode); // warm caches
+        std::vector<double> samples;
+        for (int rep = 0; rep < 7; ++rep) {
+            auto start = std::chrono::steady_clock::now();
+            forward_block(tokens.data(), 1, (int)tokens.size(), probs.data(), mode);
+            samples.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+        }
+        std::nth_element(samples.begin(), samples.begin() + samples.size() / 2, samples.end());
+        double median = samples[samples.size() / 2];
+        std::cerr << "[NATIVE] calibration " << mode_name(mode) << ": " << median << " us" << std::endl;
+        if (median < best_us) {
+            best_us = median;
+            best = mode;
+        }
+    }
+    mode_ = best;
+    if (mode_ != DirectionMode::Threaded) worker_.reset(); // do not keep an idle thread around
+}
+
+// Run both directions of one bidirectional layer over a batch with the GEMM kernels
+void NativeEngine::run_batched_layer(const BiLstmLayer& layer, const float* x, int batch, int steps,
+                                     float* out_seq, float* final_h, DirectionMode mode,
+                                     const std::atomic<bool>* cancel) const {
+    int units = layer.fw.units;
+    BatchedDirectionJob fw_job = {&layer.fw, x, batch, steps, false, out_seq, 2 * units, final_h, 2 * units};
+    BatchedDirectionJob bw_job = {&layer.bw, x, batch, steps, true, out_seq ? out_seq + units : nullptr, 2 * units,
+                                  final_h ? final_h + units : nullptr, 2 * units};
+    fw_job.cancel = bw_job.cancel = cancel;
+    run_batched_pair(layer.kernel.run, fw_job, bw_job, mode);
+}
+
+// Each direction is already a GEMM with plenty of independent work, so the
+// only split worth doing is across threads
+void NativeEngine::run_batched_pair(BatchedKernel kernel, const BatchedDirectionJob& fw_job,
+                                    const BatchedDirectionJob& bw_job, DirectionMode mode) const {
+    if (mode == DirectionMode::Threaded && worker_ && worker_->try_acquire()) {
+        struct Task { const BatchedDirectionJob* job; BatchedKernel kernel; } task = {&bw_job, kernel};
+        worker_->post([](void* p) { Task* t = static_cast<Task*>(p); t->kernel(*t->job); }, &task);
+        kernel(fw_job);
+        worker_->wait();
+        worker_->release();
+    } else {
+        kernel(fw_job);
+        kernel(bw_job);
+    }
+}
+
+// Gather embedding rows for count token ids; unknown ids map to the padding row
+void NativeEngine::embed(const float* tokens, int count, float* x) const {
+    for (int t = 0; t < count; ++t) {
+        int id = (int)tokens[t];
+        if (id < 0 || id >= vocab_size_) id = 0;
+        size_t row = (size_t)id * embedding_dim_;
+        if (weights_ == WeightType::F32)
+            std::memcpy(x + (size_t)t * embedding_dim_, &embedding_[row], sizeof(float) * embedding_dim_);
+        else
+            widen_to_float(&embedding16_[row], weights_, embedding_dim_, x + (size_t)t * embedding_dim_);
+    }
+}
+
+// Dense relu -> Dense softmax on the final states of layer 2
+void NativeEngine::classify_head(const float* last2, float* probs) const {
+    ScratchArena::Scope scope;
+    float* hidden = ScratchArena::local().floats(dense1_.units);
+    dense_forward(dense1_, last2, hidden, true);
+    dense_forward(dense2_, hidden, probs, false);
+    float max_logit = *std::max_element(probs, probs + dense2_.units);
+    float sum = 0.0f;
+    for (int j = 0; j < dense2_.units; ++j) sum += (probs[j] = std::exp(probs[j] - max_logit));
+    for (int j = 0; j < dense2_.units; ++j) probs[j] /= sum;
+}
+
+// Forward pass for a block of sequences, every layer run over the whole block at once.
+// A single sequence takes this path too. All scratch memory of the block comes from this
+// thread's arena and is released when it returns.
+void NativeEngine::forward_block(const float* tokens, int batch, int seq_len, float* probs, DirectionMode mode) const {
+    int units1 = lstm1_.fw.units, units2 = lstm2_.fw.units;
+    ScratchArena::Scope scope;
+    ScratchArena& arena = ScratchArena::local();
+
+    float* x = arena.floats((size_t)batch * seq_len * embedding_dim_);
+    embed(tokens, batch * seq_len, x);
+
+    float* seq1 = arena.floats((size_t)batch * seq_len * 2 * units1);
+    run_batched_layer(lstm1_, x, batch, seq_len, seq1, nullptr, mode);
+
+    float* last2 = arena.floats((size_t)batch * 2 * units2);
+    run_batched_layer(lstm2_, seq1, batch, seq_len, nullptr, last2, mode);
+    for (int b = 0; b < batch; ++b)
+        classify_head(&last2[(size_t)b * 2 * units2], probs + (size_t)b * dense2_.units);
+}
+
+bool NativeEngine::run(const float* input, int batch, int seq_len, std::vector<float>& out) const {
+    if (vocab_size_ == 0 || seq_len <= 0) return false;
+    out.resize((size_t)batch * dense2_.units);
+    // Blocks bound the hoisted input projection to a few MB
+    for (int b = 0; b < batch; b += kBatchBlock) {
+        int block = std::min(kBatchBlock, batch - b);
+        forward_block(input + (size_t)b * seq_len, block, seq_len, out.data() + (size_t)b * dense2_.units, mode_);
+    }
+    return true;
+}
+
+// Layer 1 forward: steps [0, reuse) come from the cache, [reuse, seq_len) continue from
+// the cached state at reuse - 1. Everything downstream depends on the backward
+// direction, which sees the whole input, so it is recomputed.
+bool NativeEngine::run_incremental(const float* input, int seq_len, PrefixCache& cache, std::vector<float>& out,
+                                   const std::atomic<bool>* cancel) const {
+    if (vocab_size_ == 0 || seq_len <= 0) return false;
+    const int units1 = lstm1_.fw.units, units2 = lstm2_.fw.units;
+    if (cache.owner != this) {
+        cache = PrefixCache();
+        cache.owner = this;
+    }
+    int reuse = 0;
+    int common = std::min((int)cache.tokens.size(), seq_len);
+    while (reuse < common && cache.tokens[reuse] == input[reuse]) ++reuse;
+    if (reuse == seq_len && (int)cache.tokens.size() == seq_len) {
+        out = cache.out;
+        return true;
+    }
+    cache.tokens.resize(reuse); // entries past reuse are only valid once this run completes
+    cache.h.resize((size_t)seq_len * units1);
+    cache.c.resize((size_t)seq_len * units1);
+
+    ScratchArena::Scope scope;
+    ScratchArena& arena = ScratchArena::local();
+    float* x = arena.floats((size_t)seq_len * embedding_dim_);
+    embed(input, seq_len, x);
+    float* seq1 = arena.floats((size_t)seq_len * 2 * units1);
+    for (int t = 0; t < reuse; ++t)
+        std::copy(&cache.h[(size_t)t * units1], &cache.h[(size_t)(t + 1) * units1], seq1 + (size_t)t * 2 * units1);
+
+    BatchedDirectionJob fw_job = {&lstm1_.fw, x + (size_t)reuse * embedding_dim_, 1, seq_len - reuse, false,
+                                  seq1 + (size_t)reuse * 2 * units1, 2 * units1, nullptr, 0};
+    BatchedDirectionJob bw_job = {&lstm1_.bw, x, 1, seq_len, true, seq1 + units1, 2 * units1, nullptr, 0};
+    if (reuse > 0) {
+        fw_job.h0 = &cache.h[(size_t)(reuse - 1) * units1];
+        fw_job.c0 = &cache.c[(size_t)(reuse - 1) * units1];
+    }
+    fw_job.out_c = cache.c.data() + (size_t)reuse * units1;
+    fw_job.cancel = bw_job.cancel = cancel;
+    run_batched_pair(lstm1_.kernel.run, fw_job, bw_job, mode_);
+
+    float* last2 = arena.floats(2 * units2);
+    run_batched_layer(lstm2_, seq1, 1, seq_len, nullptr, last2, mode_, cancel);
+    if (cancel && cancel->load()) return false;
+
+    for (int t = reuse; t < seq_len; ++t)
+        std::copy(seq1 + (size_t)t * 2 * units1, seq1 + (size_t)t * 2 * units1 + units1, &cache.h[(size_t)t * units1]);
+    cache.tokens.assign(input, input + seq_len);
+    out.resize(dense2_.units);
+    classify_head(last2, out.data());
+    cache.out = out;
+    return true;
+}
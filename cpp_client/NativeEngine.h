@@ -0,0 +1,78 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "DirectionWorker.h"
+#include "InferenceEngine.h"
+#include "LstmKernels.h"
+#include "ModelBundle.h"
+
+// How the two directions of each bidirectional layer are executed
+enum class DirectionMode {
+    Auto,        // pick the fastest of the modes below with a startup calibration
+    Sequential,  // forward, then backward
+    Threaded,    // backward on a pinned helper thread while the caller runs forward
+};
+
+// Both directions of one bidirectional layer, packed at load, plus the kernel chosen for its shape
+struct BiLstmLayer {
+    PackedLstm fw, bw;
+    LstmKernel kernel;
+};
+
+// Pure C++ forward pass of the emotion model:
+// Embedding -> BiLSTM (sequences) -> BiLSTM (last state) -> Dense relu -> Dense softmax
+class NativeEngine : public InferenceEngine {
+public:
+    explicit NativeEngine(DirectionMode mode = DirectionMode::Auto, WeightType weights = WeightType::Auto)
+        : mode_(mode), weights_(weights) {}
+
+    // Load weights from a bundle written by export_bundle.py, repack them into
+    // gate-interleaved panels stored in the requested precision (the bundle's own by
+    // default), pick the batched LSTM kernel compiled for the bundle's dimensions, then
+    // calibrate if mode is Auto
+    bool load(const std::string& bundle_path);
+
+    bool run(const float* input, int batch, int seq_len, std::vector<float>& out) const override;
+
+    // Keeps the first layer's forward-direction h and c for every step. The steps before
+    // the first token that differs from the cached input are not recomputed; the rest
+    // of the forward direction, the backward direction and layer 2 run as usual.
+    // cancel is checked before every LSTM step.
+    bool run_incremental(const float* input, int seq_len, PrefixCache& cache, std::vector<float>& out,
+                         const std::atomic<bool>* cancel) const override;
+    bool dynamic_length() const override { return true; }
+
+    DirectionMode direction_mode() const { return mode_; }
+    WeightType weight_type() const { return weights_; }
+
+    // Bytes held by the embedding and LSTM weights
+    size_t weight_bytes() const;
+
+    // Bytes reserved by the direction helper thread's scratch arena; 0 without a helper
+    // or while another thread is using it
+    size_t helper_arena_capacity() const;
+
+private:
+    DirectionMode mode_;
+    WeightType weights_;
+    int vocab_size_ = 0;
+    int embedding_dim_ = 0;
+    std::vector<float> embedding_;      // [vocab_size, embedding_dim] when weights_ is F32
+    std::vector<uint16_t> embedding16_; // same as fp16/bf16 bits otherwise
+    BiLstmLayer lstm1_, lstm2_;
+    PackedDense dense1_, dense2_;
+    std::unique_ptr<DirectionWorker> worker_;
+
+    void forward_block(const float* tokens, int batch, int seq_len, float* probs, DirectionMode mode) const;
+    void run_batched_layer(const BiLstmLayer& layer, const float* x, int batch, int steps,
+                           float* out_seq, float* final_h, DirectionMode mode,
+                           const std::atomic<bool>* cancel = nullptr) const;
+    void run_batched_pair(BatchedKernel kernel, const BatchedDirectionJob& fw_job,
+                          const BatchedDirectionJob& bw_job, DirectionMode mode) const;
+    void embed(const float* tokens, int count, float* x) const;
+    void classify_head(const float* last2, float* probs) const;
+    void calibrate();
+};
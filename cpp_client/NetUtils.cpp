@@ -0,0 +1,131 @@
+#include "NetUtils.h"
+#include <arpa/inet.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cstring>
+
+// Open a listening socket on all interfaces
+int listen_tcp(int port) {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(port);
+    if (::bind(fd, (sockaddr*)&addr, sizeof(addr)) < 0 || ::listen(fd, 128) < 0) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Non-blocking connect bounded by timeout_ms, then switch back to blocking mode
+int connect_tcp(const std::string& host, int port, int timeout_ms) {
+    addrinfo hints;
+    std::memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* res = nullptr;
+    if (getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &res) != 0 || !res)
+        return -1;
+
+    int fd = ::socket(res->ai_family, res->ai_socktype, res->ai_protocol);
+    if (fd < 0) {
+        freeaddrinfo(res);
+        return -1;
+    }
+    int flags = fcntl(fd, F_GETFL, 0);
+    fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+
+    int rc = ::connect(fd, res->ai_addr, res->ai_addrlen);
+    freeaddrinfo(res);
+    if (rc < 0 && errno != EINPROGRESS) {
+        ::close(fd);
+        return -1;
+    }
+    if (rc < 0) {
+        pollfd pfd = {fd, POLLOUT, 0};
+        int err = 0;
+        socklen_t len = sizeof(err);
+        if (poll(&pfd, 1, timeout_ms) <= 0 ||
+            getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &len) < 0 || err != 0) {
+            ::close(fd);
+            return -1;
+        }
+    }
+    fcntl(fd, F_SETFL, flags);
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return fd;
+}
+
+// Split "host:port"
+bool parse_endpoint(const std::string& endpoint, std::string& host, int& port) {
+    size_t colon = endpoint.rfind(':');
+    if (colon == std::string::npos || colon == 0) return false;
+    host = endpoint.substr(0, colon);
+    try {
+        port = std::stoi(endpoint.substr(colon + 1));
+    } catch (...) {
+        return false;
+    }
+    return port > 0 && port < 65536;
+}
+
+LineSocket::~LineSocket() {
+    close();
+}
+
+void LineSocket::close() {
+    if (fd_ >= 0) ::close(fd_);
+    fd_ = -1;
+    buffer_.clear();
+}
+
+// Write the whole line, retrying on partial writes
+bool LineSocket::send_line(const std::string& line) {
+    if (fd_ < 0) return false;
+    std::string msg = line + "\n";
+    size_t sent = 0;
+    while (sent < msg.size()) {
+        ssize_t n = ::send(fd_, msg.data() + sent, msg.size() - sent, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        sent += n;
+    }
+    return true;
+}
+
+// Buffered read up to the next '\n'
+bool LineSocket::recv_line(std::string& line, int timeout_ms) {
+    if (fd_ < 0) return false;
+    for (;;) {
+        size_t nl = buffer_.find('\n');
+        if (nl != std::string::npos) {
+            line = buffer_.substr(0, nl);
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            buffer_.erase(0, nl + 1);
+            return true;
+        }
+        pollfd pfd = {fd_, POLLIN, 0};
+        int rc = poll(&pfd, 1, timeout_ms);
+        if (rc < 0 && errno == EINTR) continue;
+        if (rc <= 0) return false;
+
+        char chunk[4096];
+        ssize_t n = ::recv(fd_, chunk, sizeof(chunk), 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        buffer_.append(chunk, n);
+    }
+}
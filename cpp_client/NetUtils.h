@@ -0,0 +1,37 @@
+#pragma once
+
+#include <string>
+
+// Minimal line-oriented TCP helpers used by the worker and router (POSIX only)
+
+// Open a listening socket on all interfaces; returns -1 on failure
+int listen_tcp(int port);
+
+// Connect to host:port, giving up after timeout_ms; returns -1 on failure
+int connect_tcp(const std::string& host, int port, int timeout_ms);
+
+// Split "host:port" into its parts; returns false if malformed
+bool parse_endpoint(const std::string& endpoint, std::string& host, int& port);
+
+// A connected socket that reads and writes newline-terminated messages
+class LineSocket {
+public:
+    explicit LineSocket(int fd = -1) : fd_(fd) {}
+    ~LineSocket();
+
+    LineSocket(const LineSocket&) = delete;
+    LineSocket& operator=(const LineSocket&) = delete;
+
+    // Send line followed by '\n'
+    bool send_line(const std::string& line);
+
+    // Read the next line (without '\n'); timeout_ms < 0 blocks forever
+    bool recv_line(std::string& line, int timeout_ms = -1);
+
+    void close();
+    bool valid() const { return fd_ >= 0; }
+
+private:
+    int fd_;
+    std::string buffer_;
+};
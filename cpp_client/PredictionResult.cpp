@@ -0,0 +1,25 @@
+#include "PredictionResult.h"
+
+const char* prediction_status_name(PredictionStatus status) {
+    switch (status) {
+    case PredictionStatus::Ok: return "ok";
+    case PredictionStatus::NotReady: return "not ready";
+    case PredictionStatus::Failed: return "failed";
+    case PredictionStatus::Cancelled: return "cancelled";
+    }
+    return "unknown";
+}
+
+// Insertion sort: there are at most kMaxClasses entries
+void PredictionResult::set_scores(const float* scores, const std::vector<std::string>& labels) {
+    num_classes = (int)labels.size();
+    for (int j = 0; j < num_classes; ++j) {
+        probs[j] = scores[j];
+        int k = j;
+        for (; k > 0 && probs[ranking[k - 1]] < scores[j]; --k) ranking[k] = ranking[k - 1];
+        ranking[k] = (int8_t)j;
+    }
+    class_id = ranking[0];
+    label = labels[class_id];
+    status = PredictionStatus::Ok;
+}
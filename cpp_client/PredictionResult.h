@@ -0,0 +1,49 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Classes a result can hold: the six emotions of the shipped model
+constexpr int kMaxClasses = 6;
+
+enum class PredictionStatus : uint8_t {
+    Ok,
+    NotReady,  // no model loaded
+    Failed,    // the engine reported an error or returned an unexpected output size
+    Cancelled, // superseded by a newer request before it finished
+};
+
+const char* prediction_status_name(PredictionStatus status);
+
+// Microseconds spent in each stage of one prediction. The members of a batch share
+// one engine run, so each of them reports that run's time as inference_us.
+struct StageTimings {
+    float preprocess_us = 0.0f;
+    float inference_us = 0.0f;
+    float postprocess_us = 0.0f;
+};
+
+// Outcome of classifying one input, without heap memory. label points into the
+// classifier's label list and is valid only while that classifier is alive.
+struct PredictionResult {
+    PredictionStatus status = PredictionStatus::NotReady;
+    int class_id = -1;
+    std::string_view label;
+    int num_classes = 0;
+    std::array<float, kMaxClasses> probs{};    // softmax output, indexed by class id
+    std::array<int8_t, kMaxClasses> ranking{}; // class ids by decreasing probability
+    bool from_cascade = false;                 // answered by the cascade, not the full model
+    StageTimings timings;
+
+    bool ok() const { return status == PredictionStatus::Ok; }
+    float confidence() const { return ok() ? probs[class_id] : 0.0f; }
+
+    // Class id of the k-th most likely class; top(0) == class_id
+    int top(int k) const { return ranking[k]; }
+
+    // Take labels.size() probabilities from scores; sets class_id, label, ranking and status Ok
+    void set_scores(const float* scores, const std::vector<std::string>& labels);
+};
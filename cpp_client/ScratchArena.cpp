@@ -0,0 +1,53 @@
+#include "ScratchArena.h"
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+ScratchArena& ScratchArena::local() {
+    thread_local ScratchArena arena;
+    return arena;
+}
+
+ScratchArena::~ScratchArena() {
+    for (Slab& slab : slabs_) ::operator delete(slab.data, std::align_val_t(kAlignment));
+}
+
+// Bump within the current slab, else move on to the next slab that fits. A request
+// replays the same sequence of sizes, so after the first one every allocation
+// lands in a slab that already exists.
+void* ScratchArena::allocate(size_t bytes) {
+    bytes = (bytes + kAlignment - 1) / kAlignment * kAlignment;
+    while (slab_ < slabs_.size()) {
+        if (used_ + bytes <= slabs_[slab_].size) {
+            void* p = slabs_[slab_].data + used_;
+            used_ += bytes;
+            return p;
+        }
+        ++slab_;
+        used_ = 0;
+    }
+    size_t size = std::max(bytes, kSlabSize);
+    slabs_.push_back({static_cast<unsigned char*>(::operator new(size, std::align_val_t(kAlignment))), size});
+    slab_ = slabs_.size() - 1;
+    used_ = bytes;
+    return slabs_.back().data;
+}
+
+float* ScratchArena::zeros(size_t count) {
+    float* p = floats(count);
+    std::memset(p, 0, count * sizeof(float));
+    return p;
+}
+
+size_t ScratchArena::capacity() const {
+    size_t total = 0;
+    for (const Slab& slab : slabs_) total += slab.size;
+    return total;
+}
+
+ScratchArena::Scope::Scope() : arena_(ScratchArena::local()), slab_(arena_.slab_), used_(arena_.used_) {}
+
+ScratchArena::Scope::~Scope() {
+    arena_.slab_ = slab_;
+    arena_.used_ = used_;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// Per-thread bump allocator for inference scratch memory (LSTM states, layer
+// outputs, projections). Memory comes from 64-byte-aligned slabs that are kept
+// after a request finishes, so once the first request of a given shape has
+// grown the slabs, later requests allocate nothing from the heap.
+//
+// Allocations are released in bulk by Scope:
+//     ScratchArena::Scope scope;               // remembers the current position
+//     float* h = ScratchArena::local().floats(units);
+//     ...                                      // everything since scope is freed at its end
+class ScratchArena {
+public:
+    static constexpr size_t kAlignment = 64;
+
+    // The calling thread's arena
+    static ScratchArena& local();
+
+    ScratchArena() = default;
+    ~ScratchArena();
+    ScratchArena(const ScratchArena&) = delete;
+    ScratchArena& operator=(const ScratchArena&) = delete;
+
+    // bytes of uninitialized memory aligned to kAlignment
+    void* allocate(size_t bytes);
+
+    // count uninitialized floats
+    float* floats(size_t count) { return static_cast<float*>(allocate(count * sizeof(float))); }
+
+    // count floats set to zero
+    float* zeros(size_t count);
+
+    // Total bytes reserved in slabs, for diagnostics
+    size_t capacity() const;
+
+    // Restores the arena of the thread that created it to where it was
+    class Scope {
+    public:
+        Scope();
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        ScratchArena& arena_;
+        size_t slab_;
+        size_t used_;
+    };
+
+private:
+    struct Slab {
+        unsigned char* data;
+        size_t size;
+    };
+    static constexpr size_t kSlabSize = size_t(4) << 20;
+
+    std::vector<Slab> slabs_;
+    size_t slab_ = 0; // slab currently bumped from
+    size_t used_ = 0; // bytes used in that slab
+};
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+// Read-only word -> index table laid out at build time by embed_assets, so a vocabulary
+// compiled into the executable is usable without parsing or allocating anything.
+// Open addressing with linear probing over a power-of-two slot array.
+struct StaticVocabulary {
+    struct Entry {
+        uint32_t hash;
+        uint32_t offset; // into chars
+        uint32_t length;
+        int32_t index;
+    };
+
+    const uint32_t* slots; // entry number + 1, or 0 for an empty slot
+    uint32_t mask;         // slot count - 1
+    const Entry* entries;
+    uint32_t size;
+    const unsigned char* chars;
+
+    // 32-bit FNV-1a; embed_assets places words with the same function
+    static uint32_t hash(const char* data, size_t len) {
+        uint32_t h = 2166136261u;
+        for (size_t i = 0; i < len; ++i) {
+            h ^= (unsigned char)data[i];
+            h *= 16777619u;
+        }
+        return h;
+    }
+
+    // Index of word, or -1 if it is not in the vocabulary
+    int find(const std::string& word) const {
+        const uint32_t h = hash(word.data(), word.size());
+        for (uint32_t slot = h & mask;; slot = (slot + 1) & mask) {
+            if (slots[slot] == 0) return -1;
+            const Entry& entry = entries[slots[slot] - 1];
+            if (entry.hash == h && entry.length == word.size() &&
+                std::memcmp(chars + entry.offset, word.data(), word.size()) == 0)
+                return entry.index;
+        }
+    }
+};
@@ -0,0 +1,290 @@
+#include "TFEngine.h"
+#include "TFLoader.h"
+#include "Timing.h"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string_view>
+
+TFEngine::~TFEngine() {
+    release();
+}
+
+// Close the session and free the graph, if any
+void TFEngine::release() {
+    const TFApi& tf = tf_api();
+    if (sess_) {
+        TF_Status* status = tf.NewStatus();
+        tf.CloseSession(sess_, status);
+        tf.DeleteSession(sess_, status);
+        tf.DeleteStatus(status);
+        sess_ = nullptr;
+    }
+    if (graph_) {
+        tf.DeleteGraph(graph_);
+        graph_ = nullptr;
+    }
+}
+
+// Just enough of the protobuf wire format to read the serving signature out of a MetaGraphDef
+namespace {
+
+bool read_varint(const char*& p, const char* end, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; p < end && shift < 64; shift += 7) {
+        uint8_t byte = (uint8_t)*p++;
+        value |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+// Payloads of every length-delimited field number wanted in message (a repeated or map field)
+std::vector<std::string_view> fields(std::string_view message, uint32_t wanted) {
+    std::vector<std::string_view> found;
+    const char* p = message.data();
+    const char* end = p + message.size();
+    uint64_t key, value;
+    while (p < end && read_varint(p, end, key)) {
+        switch (key & 7) {
+        case 0:
+            if (!read_varint(p, end, value)) return found;
+            break;
+        case 1:
+        case 5: {
+            size_t size = (key & 7) == 1 ? 8 : 4;
+            if ((size_t)(end - p) < size) return found;
+            p += size;
+            break;
+        }
+        case 2:
+            if (!read_varint(p, end, value) || value > (uint64_t)(end - p)) return found;
+            if ((key >> 3) == wanted) found.emplace_back(p, (size_t)value);
+            p += value;
+            break;
+        default: // groups; MetaGraphDef has none
+            return found;
+        }
+    }
+    return found;
+}
+
+// Tensor names of the inputs (which = 1) or outputs (which = 2) of the serving_default
+// signature: MetaGraphDef.signature_def[key].inputs/outputs[*].name
+std::vector<std::string> serving_tensors(std::string_view meta_graph, uint32_t which) {
+    std::vector<std::string> names;
+    for (std::string_view entry : fields(meta_graph, 5)) {
+        std::vector<std::string_view> key = fields(entry, 1);
+        if (key.empty() || key[0] != "serving_default") continue;
+        for (std::string_view signature : fields(entry, 2))
+            for (std::string_view tensor : fields(signature, which))
+                for (std::string_view info : fields(tensor, 2))
+                    for (std::string_view name : fields(info, 1)) names.emplace_back(name);
+    }
+    return names;
+}
+
+// "op:index" in graph, or a null operation
+TF_Output tensor_by_name(TF_Graph* graph, const std::string& name) {
+    if (name.empty()) return {nullptr, 0};
+    size_t colon = name.rfind(':');
+    int index = colon == std::string::npos ? 0 : std::atoi(name.c_str() + colon + 1);
+    return {tf_api().GraphOperationByName(graph, name.substr(0, colon).c_str()), index};
+}
+
+// The one candidate, or an error that names them all
+bool only_candidate(const char* what, const std::string& expected, const std::vector<TF_Output>& candidates,
+                    TF_Output& out) {
+    if (candidates.size() == 1) {
+        out = candidates[0];
+        return true;
+    }
+    std::cerr << "ERROR: no model " << what << (expected.empty() ? "" : " named " + expected) << ", and "
+              << (candidates.empty() ? "no operation could be it" : "several operations could be it:");
+    for (const TF_Output& candidate : candidates) std::cerr << " " << tf_api().OperationName(candidate.oper);
+    std::cerr << std::endl;
+    return false;
+}
+
+} // namespace
+
+// Use the named input and output tensors ("op:index") when the graph has them. Otherwise
+// take the only float Placeholder and the only float tensor nothing consumes, and refuse
+// to guess between several.
+bool TFEngine::resolve_io(const std::string& input_name, const std::string& output_name) {
+    const TFApi& tf = tf_api();
+    input_op_ = tensor_by_name(graph_, input_name);
+    output_op_ = tensor_by_name(graph_, output_name);
+
+    if (!input_op_.oper || !output_op_.oper) {
+        std::vector<TF_Output> inputs, outputs;
+        size_t pos = 0;
+        while (TF_Operation* op = tf.GraphNextOperation(graph_, &pos)) {
+            if (tf.OperationNumOutputs(op) < 1) continue;
+            TF_Output out = {op, 0};
+            if (tf.OperationOutputType(out) != TF_FLOAT) continue;
+            std::string type = tf.OperationOpType(op);
+            if (type == "Placeholder")
+                inputs.push_back(out);
+            else if (type != "Const" && type != "VarHandleOp" && tf.OperationOutputNumConsumers(out) == 0)
+                outputs.push_back(out);
+        }
+        if (!input_op_.oper && !only_candidate("input", input_name, inputs, input_op_)) return false;
+        if (!output_op_.oper && !only_candidate("output", output_name, outputs, output_op_)) return false;
+    }
+
+    // A dynamic time dimension lets callers feed length buckets shorter than max_len
+    TF_Status* status = tf.NewStatus();
+    int64_t dims[2] = {0, 0};
+    dynamic_length_ = tf.GraphGetTensorNumDims(graph_, input_op_, status) == 2 && tf.GetCode(status) == TF_OK;
+    if (dynamic_length_) {
+        tf.GraphGetTensorShape(graph_, input_op_, dims, 2, status);
+        dynamic_length_ = tf.GetCode(status) == TF_OK && dims[1] < 0;
+    }
+    tf.DeleteStatus(status);
+
+    std::cerr << "[LOAD] model input " << tf.OperationName(input_op_.oper) << ":" << input_op_.index
+              << (dynamic_length_ ? " (dynamic length)" : "") << ", output " << tf.OperationName(output_op_.oper)
+              << ":" << output_op_.index << std::endl;
+    return true;
+}
+
+// Load the SavedModel and resolve the input/output of its serving signature
+bool TFEngine::load(const std::string& export_dir) {
+    std::string error;
+    if (!tf_load_library(&error)) {
+        std::cerr << "ERROR: " << error << std::endl;
+        return false;
+    }
+    release();
+    const TFApi& tf = tf_api();
+    const char* tag = "serve";
+
+    auto start = std::chrono::steady_clock::now();
+    double rss_before = resident_set_mb();
+
+    TF_Status* status = tf.NewStatus();
+    TF_SessionOptions* opts = tf.NewSessionOptions();
+    TF_Buffer* meta_graph = tf.NewBuffer();
+    graph_ = tf.NewGraph();
+    sess_ = tf.LoadSessionFromSavedModel(opts, nullptr, export_dir.c_str(), &tag, 1, graph_, meta_graph, status);
+    tf.DeleteSessionOptions(opts);
+
+    if (tf.GetCode(status) != TF_OK) {
+        std::cerr << "ERROR loading model: " << tf.Message(status) << std::endl;
+        tf.DeleteStatus(status);
+        tf.DeleteBuffer(meta_graph);
+        sess_ = nullptr;
+        release();
+        return false;
+    }
+    tf.DeleteStatus(status);
+
+    std::string_view meta(static_cast<const char*>(meta_graph->data), meta_graph->length);
+    std::vector<std::string> inputs = serving_tensors(meta, 1), outputs = serving_tensors(meta, 2);
+    tf.DeleteBuffer(meta_graph);
+    if (inputs.size() > 1 || outputs.size() > 1) {
+        std::cerr << "ERROR: the serving signature has " << inputs.size() << " inputs and " << outputs.size()
+                  << " outputs, the client needs exactly one of each" << std::endl;
+        release();
+        return false;
+    }
+    if (!resolve_io(inputs.empty() ? "" : inputs[0], outputs.empty() ? "" : outputs[0])) {
+        release();
+        return false;
+    }
+    std::cerr << "[LOAD] SavedModel in " << std::chrono::duration<double, std::milli>(
+                     std::chrono::steady_clock::now() - start).count()
+              << " ms, RSS +" << resident_set_mb() - rss_before << " MB" << std::endl;
+    return true;
+}
+
+// Import a frozen GraphDef (weights baked in as constants) and open a session on it
+bool TFEngine::load_frozen(const std::string& graph_path) {
+    std::string error;
+    if (!tf_load_library(&error)) {
+        std::cerr << "ERROR: " << error << std::endl;
+        return false;
+    }
+    release();
+    const TFApi& tf = tf_api();
+
+    auto start = std::chrono::steady_clock::now();
+    double rss_before = resident_set_mb();
+
+    std::ifstream infile(graph_path, std::ios::binary);
+    std::string bytes((std::istreambuf_iterator<char>(infile)), std::istreambuf_iterator<char>());
+    if (bytes.empty()) {
+        std::cerr << "ERROR: cannot read frozen graph " << graph_path << std::endl;
+        return false;
+    }
+
+    TF_Status* status = tf.NewStatus();
+    TF_Buffer* graph_def = tf.NewBufferFromString(bytes.data(), bytes.size());
+    TF_ImportGraphDefOptions* import_opts = tf.NewImportGraphDefOptions();
+    graph_ = tf.NewGraph();
+    tf.GraphImportGraphDef(graph_, graph_def, import_opts, status);
+    tf.DeleteImportGraphDefOptions(import_opts);
+    tf.DeleteBuffer(graph_def);
+
+    if (tf.GetCode(status) == TF_OK) {
+        TF_SessionOptions* opts = tf.NewSessionOptions();
+        sess_ = tf.NewSession(graph_, opts, status);
+        tf.DeleteSessionOptions(opts);
+    }
+    if (tf.GetCode(status) != TF_OK) {
+        std::cerr << "ERROR loading frozen graph: " << tf.Message(status) << std::endl;
+        tf.DeleteStatus(status);
+        sess_ = nullptr;
+        release();
+        return false;
+    }
+    tf.DeleteStatus(status);
+
+    // export_frozen.py names them
+    if (!resolve_io("input:0", "output:0")) {
+        release();
+        return false;
+    }
+    std::cerr << "[LOAD] frozen graph in " << std::chrono::duration<double, std::milli>(
+                     std::chrono::steady_clock::now() - start).count()
+              << " ms, RSS +" << resident_set_mb() - rss_before << " MB" << std::endl;
+    return true;
+}
+
+// Run one batch through the resident session
+bool TFEngine::run(const float* input, int batch, int seq_len, std::vector<float>& out) const {
+    if (!sess_) return false;
+    const TFApi& tf = tf_api();
+
+    const int64_t dims[2] = {batch, seq_len};
+    size_t input_bytes = sizeof(float) * batch * seq_len;
+    TF_Tensor* input_tensor = tf.AllocateTensor(TF_FLOAT, dims, 2, input_bytes);
+    std::memcpy(tf.TensorData(input_tensor), input, input_bytes);
+
+    TF_Tensor* output_tensor = nullptr;
+    TF_Status* status = tf.NewStatus();
+    tf.SessionRun(sess_,
+                  nullptr,
+                  &input_op_, &input_tensor, 1,
+                  &output_op_, &output_tensor, 1,
+                  nullptr, 0,
+                  nullptr,
+                  status);
+    tf.DeleteTensor(input_tensor);
+
+    if (tf.GetCode(status) != TF_OK) {
+        std::cerr << "ERROR during inference: " << tf.Message(status) << std::endl;
+        tf.DeleteStatus(status);
+        return false;
+    }
+    tf.DeleteStatus(status);
+
+    auto data = static_cast<const float*>(tf.TensorData(output_tensor));
+    size_t output_elements = tf.TensorByteSize(output_tensor) / sizeof(float);
+    out.assign(data, data + output_elements);
+    tf.DeleteTensor(output_tensor);
+    return true;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "InferenceEngine.h"
+#include "tensorflow/c/c_api.h"
+
+// Owns a TensorFlow session that is loaded once and reused for every inference call
+class TFEngine : public InferenceEngine {
+public:
+    TFEngine() = default;
+    ~TFEngine();
+
+    TFEngine(const TFEngine&) = delete;
+    TFEngine& operator=(const TFEngine&) = delete;
+
+    // Load a SavedModel from export_dir; logs and returns false on failure
+    bool load(const std::string& export_dir);
+
+    // Load a frozen, inference-optimized GraphDef written by export_frozen.py
+    bool load_frozen(const std::string& graph_path);
+
+    // Run a [batch, seq_len] input and write [batch, num_classes] scores into out
+    bool run(const float* input, int batch, int seq_len, std::vector<float>& out) const override;
+
+    bool loaded() const { return sess_ != nullptr; }
+
+    // True if the model input accepts any sequence length ([batch, None])
+    bool dynamic_length() const override { return dynamic_length_; }
+
+private:
+    TF_Graph* graph_ = nullptr;
+    TF_Session* sess_ = nullptr;
+    TF_Output input_op_ = {nullptr, 0};
+    TF_Output output_op_ = {nullptr, 0};
+    bool dynamic_length_ = false;
+
+    void release();
+    bool resolve_io(const std::string& input_name, const std::string& output_name);
+};
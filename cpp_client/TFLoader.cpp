@@ -0,0 +1,109 @@
+#include "TFLoader.h"
+#include <cstdlib>
+#include <mutex>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
+namespace {
+
+TFApi g_api;
+bool g_loaded = false;
+std::string g_error;
+std::once_flag g_once;
+
+#ifdef _WIN32
+const char* const kLibraryNames[] = {"tensorflow.dll"};
+#elif defined(__APPLE__)
+const char* const kLibraryNames[] = {"libtensorflow.2.dylib", "libtensorflow.dylib"};
+#else
+const char* const kLibraryNames[] = {"libtensorflow.so.2", "libtensorflow.so"};
+#endif
+
+void* open_library(const char* name) {
+#ifdef _WIN32
+    return (void*)LoadLibraryA(name);
+#else
+    return dlopen(name, RTLD_NOW | RTLD_LOCAL);
+#endif
+}
+
+void* find_symbol(void* lib, const char* name) {
+#ifdef _WIN32
+    return (void*)GetProcAddress((HMODULE)lib, name);
+#else
+    return dlsym(lib, name);
+#endif
+}
+
+// Resolve one symbol into a typed function pointer; returns false if missing
+template <typename Fn>
+bool resolve(void* lib, const char* name, Fn& fn) {
+    fn = reinterpret_cast<Fn>(find_symbol(lib, name));
+    if (!fn) g_error = std::string("TensorFlow library is missing symbol ") + name;
+    return fn != nullptr;
+}
+
+void load_once() {
+    // TF_LIBRARY_PATH lets users point at a library outside the search path
+    void* lib = nullptr;
+    if (const char* path = std::getenv("TF_LIBRARY_PATH")) lib = open_library(path);
+    for (const char* name : kLibraryNames) {
+        if (lib) break;
+        lib = open_library(name);
+    }
+    if (!lib) {
+        g_error = std::string("Could not load the TensorFlow library (") + kLibraryNames[0] +
+                  "). Copy it next to the executable or set TF_LIBRARY_PATH.";
+        return;
+    }
+
+    g_loaded =
+        resolve(lib, "TF_NewStatus", g_api.NewStatus) &&
+        resolve(lib, "TF_DeleteStatus", g_api.DeleteStatus) &&
+        resolve(lib, "TF_GetCode", g_api.GetCode) &&
+        resolve(lib, "TF_Message", g_api.Message) &&
+        resolve(lib, "TF_NewGraph", g_api.NewGraph) &&
+        resolve(lib, "TF_DeleteGraph", g_api.DeleteGraph) &&
+        resolve(lib, "TF_NewSessionOptions", g_api.NewSessionOptions) &&
+        resolve(lib, "TF_DeleteSessionOptions", g_api.DeleteSessionOptions) &&
+        resolve(lib, "TF_LoadSessionFromSavedModel", g_api.LoadSessionFromSavedModel) &&
+        resolve(lib, "TF_CloseSession", g_api.CloseSession) &&
+        resolve(lib, "TF_DeleteSession", g_api.DeleteSession) &&
+        resolve(lib, "TF_GraphOperationByName", g_api.GraphOperationByName) &&
+        resolve(lib, "TF_AllocateTensor", g_api.AllocateTensor) &&
+        resolve(lib, "TF_DeleteTensor", g_api.DeleteTensor) &&
+        resolve(lib, "TF_TensorData", g_api.TensorData) &&
+        resolve(lib, "TF_TensorByteSize", g_api.TensorByteSize) &&
+        resolve(lib, "TF_SessionRun", g_api.SessionRun) &&
+        resolve(lib, "TF_NewSession", g_api.NewSession) &&
+        resolve(lib, "TF_GraphNextOperation", g_api.GraphNextOperation) &&
+        resolve(lib, "TF_OperationName", g_api.OperationName) &&
+        resolve(lib, "TF_OperationOpType", g_api.OperationOpType) &&
+        resolve(lib, "TF_OperationNumOutputs", g_api.OperationNumOutputs) &&
+        resolve(lib, "TF_OperationOutputType", g_api.OperationOutputType) &&
+        resolve(lib, "TF_OperationOutputNumConsumers", g_api.OperationOutputNumConsumers) &&
+        resolve(lib, "TF_NewBuffer", g_api.NewBuffer) &&
+        resolve(lib, "TF_NewBufferFromString", g_api.NewBufferFromString) &&
+        resolve(lib, "TF_DeleteBuffer", g_api.DeleteBuffer) &&
+        resolve(lib, "TF_NewImportGraphDefOptions", g_api.NewImportGraphDefOptions) &&
+        resolve(lib, "TF_DeleteImportGraphDefOptions", g_api.DeleteImportGraphDefOptions) &&
+        resolve(lib, "TF_GraphImportGraphDef", g_api.GraphImportGraphDef) &&
+        resolve(lib, "TF_GraphGetTensorNumDims", g_api.GraphGetTensorNumDims) &&
+        resolve(lib, "TF_GraphGetTensorShape", g_api.GraphGetTensorShape);
+}
+
+} // namespace
+
+bool tf_load_library(std::string* error) {
+    std::call_once(g_once, load_once);
+    if (!g_loaded && error) *error = g_error;
+    return g_loaded;
+}
+
+const TFApi& tf_api() {
+    return g_api;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <string>
+
+#include "tensorflow/c/c_api.h"
+
+// Function table for the part of the TensorFlow C API the client uses.
+// The library is opened with dlopen/LoadLibrary at runtime instead of being
+// linked, so the process starts without mapping and relocating libtensorflow.
+struct TFApi {
+    decltype(&TF_NewStatus) NewStatus;
+    decltype(&TF_DeleteStatus) DeleteStatus;
+    decltype(&TF_GetCode) GetCode;
+    decltype(&TF_Message) Message;
+    decltype(&TF_NewGraph) NewGraph;
+    decltype(&TF_DeleteGraph) DeleteGraph;
+    decltype(&TF_NewSessionOptions) NewSessionOptions;
+    decltype(&TF_DeleteSessionOptions) DeleteSessionOptions;
+    decltype(&TF_LoadSessionFromSavedModel) LoadSessionFromSavedModel;
+    decltype(&TF_CloseSession) CloseSession;
+    decltype(&TF_DeleteSession) DeleteSession;
+    decltype(&TF_GraphOperationByName) GraphOperationByName;
+    decltype(&TF_AllocateTensor) AllocateTensor;
+    decltype(&TF_DeleteTensor) DeleteTensor;
+    decltype(&TF_TensorData) TensorData;
+    decltype(&TF_TensorByteSize) TensorByteSize;
+    decltype(&TF_SessionRun) SessionRun;
+    decltype(&TF_NewSession) NewSession;
+    decltype(&TF_GraphNextOperation) GraphNextOperation;
+    decltype(&TF_OperationName) OperationName;
+    decltype(&TF_OperationOpType) OperationOpType;
+    decltype(&TF_OperationNumOutputs) OperationNumOutputs;
+    decltype(&TF_OperationOutputType) OperationOutputType;
+    decltype(&TF_OperationOutputNumConsumers) OperationOutputNumConsumers;
+    decltype(&TF_NewBuffer) NewBuffer;
+    decltype(&TF_NewBufferFromString) NewBufferFromString;
+    decltype(&TF_DeleteBuffer) DeleteBuffer;
+    decltype(&TF_NewImportGraphDefOptions) NewImportGraphDefOptions;
+    decltype(&TF_DeleteImportGraphDefOptions) DeleteImportGraphDefOptions;
+    decltype(&TF_GraphImportGraphDef) GraphImportGraphDef;
+    decltype(&TF_GraphGetTensorNumDims) GraphGetTensorNumDims;
+    decltype(&TF_GraphGetTensorShape) GraphGetTensorShape;
+};
+
+// Open the TensorFlow library and resolve every entry point.
+// Thread-safe; later calls return the result of the first one.
+// On failure, error (if given) receives a human-readable reason.
+bool tf_load_library(std::string* error = nullptr);
+
+// The resolved function table; only valid after tf_load_library() succeeded
+const TFApi& tf_api();
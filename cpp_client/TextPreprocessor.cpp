@@ -15,14 +15,27 @@ TextPreprocessor::TextPreprocessor(const std::string& vocab_file, int max_len)
     }
 }
 
+// Construct the preprocessor over a vocabulary table built into the executable
+TextPreprocessor::TextPreprocessor(const StaticVocabulary& vocab, int max_len)
+    : static_vocab_(&vocab), max_len_(max_len) {}
+
+// Map a cleaned word to its index in whichever vocabulary is loaded
+int TextPreprocessor::lookup(const std::string& word) const {
+    if (static_vocab_) {
+        int index = static_vocab_->find(word);
+        return index >= 0 ? index : 0;
+    }
+    auto it = word_index_.find(word);
+    return it != word_index_.end() ? it->second : 0;
+}
+
 // Preprocess input text: tokenize, map to indices, pad/truncate, convert to float vector
 std::vector<float> TextPreprocessor::preprocess(const std::string& text) const {
     std::vector<std::string> words = tokenize(text);
 
     std::vector<int> indices;
     for (auto& w : words) {
-        auto it = word_index_.find(w);
-        indices.push_back(it != word_index_.end() ? it->second : 0); // 0 for OOV
+        indices.push_back(lookup(w)); // 0 for OOV
     }
 
     if ((int)indices.size() < max_len_) {
@@ -56,4 +69,34 @@ std::vector<std::string> TextPreprocessor::tokenize(const std::string& text) {
         if (!cleaned.empty()) tokens.push_back(cleaned);
     }
     return tokens;
-}
\ No newline at end of file
+}
+
+namespace {
+
+// Call f(begin, end) for every word tokenize keeps: whitespace-separated, with an alphanumeric character
+template <class F>
+void for_each_word(const std::string& text, F f) {
+    size_t i = 0;
+    while (i < text.size()) {
+        while (i < text.size() && std::isspace(static_cast<unsigned char>(text[i]))) ++i;
+        size_t start = i;
+        bool alnum = false;
+        for (; i < text.size() && !std::isspace(static_cast<unsigned char>(text[i])); ++i)
+            alnum = alnum || std::isalnum(static_cast<unsigned char>(text[i]));
+        if (alnum) f(start, i);
+    }
+}
+
+} // namespace
+
+std::vector<std::pair<size_t, size_t>> TextPreprocessor::word_spans(const std::string& text) {
+    std::vector<std::pair<size_t, size_t>> spans;
+    for_each_word(text, [&](size_t begin, size_t end) { spans.emplace_back(begin, end); });
+    return spans;
+}
+
+int TextPreprocessor::word_count(const std::string& text) {
+    int count = 0;
+    for_each_word(text, [&](size_t, size_t) { ++count; });
+    return count;
+}
@@ -2,21 +2,37 @@
 
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
+#include "StaticVocabulary.h"
+
 // Handles text preprocessing: tokenization, cleaning, mapping to indices, and padding
 class TextPreprocessor {
 public:
     // Initialize with vocabulary file and max sequence length
     explicit TextPreprocessor(const std::string& vocab_file, int max_len = 100);
 
+    // Initialize with a vocabulary table built into the executable; it must outlive this object
+    explicit TextPreprocessor(const StaticVocabulary& vocab, int max_len = 100);
+
     // Process a string and return a padded sequence of floats (for model input)
     std::vector<float> preprocess(const std::string& text) const;
 
+    // Byte range [first, second) of every word preprocess() keeps, in order
+    static std::vector<std::pair<size_t, size_t>> word_spans(const std::string& text);
+
+    // Number of words preprocess() keeps, before truncation to max_len
+    static int word_count(const std::string& text);
+
 private:
     std::unordered_map<std::string, int> word_index_;
+    const StaticVocabulary* static_vocab_ = nullptr; // used instead of word_index_ when set
     int max_len_;
 
+    // Index of a cleaned word, 0 if out of vocabulary
+    int lookup(const std::string& word) const;
+
     // Clean a word: keep only alphanumeric, convert to lowercase
     static std::string clean_word(const std::string& word);
 
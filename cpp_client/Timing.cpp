@@ -0,0 +1,100 @@
+#include "Timing.h"
+#include <chrono>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <ctime>
+#endif
+#if defined(__linux__)
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+// Compare the process creation FILETIME against the current system time
+double ms_since_process_start() {
+    FILETIME creation, exit_time, kernel, user, now;
+    GetProcessTimes(GetCurrentProcess(), &creation, &exit_time, &kernel, &user);
+    GetSystemTimeAsFileTime(&now);
+    ULARGE_INTEGER c, n;
+    c.LowPart = creation.dwLowDateTime; c.HighPart = creation.dwHighDateTime;
+    n.LowPart = now.dwLowDateTime; n.HighPart = now.dwHighDateTime;
+    return (n.QuadPart - c.QuadPart) / 10000.0; // 100ns units
+}
+#elif defined(__linux__)
+// Compare /proc/self/stat starttime (clock ticks since boot) against /proc/uptime
+double ms_since_process_start() {
+    std::ifstream stat_file("/proc/self/stat");
+    std::string stat((std::istreambuf_iterator<char>(stat_file)), std::istreambuf_iterator<char>());
+    size_t paren = stat.rfind(')'); // the command name may contain spaces
+    std::istringstream fields(paren == std::string::npos ? "" : stat.substr(paren + 2));
+    std::string field;
+    for (int i = 3; i <= 22 && fields >> field; ++i) {}
+
+    double uptime_s = 0.0;
+    std::ifstream("/proc/uptime") >> uptime_s;
+    double start_s = std::stod(field.empty() ? "0" : field) / sysconf(_SC_CLK_TCK);
+    return (uptime_s - start_s) * 1000.0;
+}
+#else
+double ms_since_process_start() {
+    static const auto first = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - first).count();
+}
+#endif
+
+#ifdef _WIN32
+double resident_set_mb() {
+    PROCESS_MEMORY_COUNTERS pmc;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc))) return 0.0;
+    return pmc.WorkingSetSize / (1024.0 * 1024.0);
+}
+#elif defined(__linux__)
+// Second field of /proc/self/statm is resident pages
+double resident_set_mb() {
+    long pages_total = 0, pages_resident = 0;
+    std::ifstream("/proc/self/statm") >> pages_total >> pages_resident;
+    return pages_resident * (double)sysconf(_SC_PAGESIZE) / (1024.0 * 1024.0);
+}
+#else
+double resident_set_mb() {
+    return 0.0;
+}
+#endif
+
+#ifdef _WIN32
+double process_cpu_seconds() {
+    FILETIME creation, exit_time, kernel, user;
+    GetProcessTimes(GetCurrentProcess(), &creation, &exit_time, &kernel, &user);
+    ULARGE_INTEGER k, u;
+    k.LowPart = kernel.dwLowDateTime; k.HighPart = kernel.dwHighDateTime;
+    u.LowPart = user.dwLowDateTime; u.HighPart = user.dwHighDateTime;
+    return (k.QuadPart + u.QuadPart) / 1e7; // 100ns units
+}
+#else
+// std::clock is process CPU time on POSIX (it is wall time on Windows)
+double process_cpu_seconds() {
+    return (double)std::clock() / CLOCKS_PER_SEC;
+}
+#endif
+
+#ifdef _WIN32
+double thread_cpu_seconds() {
+    FILETIME creation, exit_time, kernel, user;
+    GetThreadTimes(GetCurrentThread(), &creation, &exit_time, &kernel, &user);
+    ULARGE_INTEGER k, u;
+    k.LowPart = kernel.dwLowDateTime; k.HighPart = kernel.dwHighDateTime;
+    u.LowPart = user.dwLowDateTime; u.HighPart = user.dwHighDateTime;
+    return (k.QuadPart + u.QuadPart) / 1e7; // 100ns units
+}
+#else
+double thread_cpu_seconds() {
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+#endif
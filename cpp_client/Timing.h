@@ -0,0 +1,17 @@
+#pragma once
+
+// Process-level measurements used by the startup and model-load logs
+
+// Milliseconds since the process was created, including time the dynamic
+// loader spent before main(). Falls back to time since first call if the
+// OS does not expose the process creation time.
+double ms_since_process_start();
+
+// Current resident set size in megabytes, or 0 if unavailable
+double resident_set_mb();
+
+// CPU time (user + kernel) consumed by the whole process so far, in seconds
+double process_cpu_seconds();
+
+// CPU time (user + kernel) consumed by the calling thread so far, in seconds
+double thread_cpu_seconds();
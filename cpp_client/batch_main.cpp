@@ -0,0 +1,419 @@
+// Headless batch classification of a text file with one message per line. Every
+// non-empty line is written to the output as "label<TAB>confidence<TAB>text".
+// With --follow the file is watched like tail -f: lines appended to it are classified
+// in micro-batches as they arrive, and the offset reached is saved to the offset file
+// after every batch, so a restarted run continues where the last one stopped.
+// With --checkpoint DIR a long run is classified in chunks of --chunk-lines lines, each
+// committed to DIR as it finishes; running the same command again after a crash resumes
+// after the last finished chunk, and the output is written from the chunks at the end.
+// A plain run reads and writes through io_uring (or a pread/pwrite thread pool) unless
+// --io stream selects the getline/ostream path.
+// Usage: emotion_batch --input FILE [--output FILE] [--model-dir DIR] [--batch N]
+//                      [--io auto|uring|threads|stream] [--follow] [--offset-file FILE]
+//                      [--max-delay-ms N] [--checkpoint DIR] [--chunk-lines N] [--restart]
+//                      [classifier options]
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "BatchCheckpoint.h"
+#include "BatchIO.h"
+#include "ClassifierHost.h"
+#include "LogFollower.h"
+
+static std::atomic<bool> stop_requested{false};
+
+static void on_stop_signal(int) {
+    stop_requested = true;
+}
+
+static void write_result(std::ostream& out, const PredictionResult& result, const std::string& text) {
+    if (result.ok()) out << result.label << '\t' << result.confidence() << '\t' << text << '\n';
+    else out << "error\t0\t" << text << '\n';
+}
+
+// Classify texts in batches of batch_size and write one result line per text
+static void classify_and_write(const EmotionClassifier& classifier, const std::vector<std::string>& texts,
+                               size_t batch_size, std::ostream& out) {
+    std::vector<PredictionResult> results(std::min(texts.size(), batch_size));
+    std::vector<std::string> batch;
+    for (size_t i = 0; i < texts.size(); i += batch_size) {
+        size_t end = std::min(texts.size(), i + batch_size);
+        batch.assign(texts.begin() + i, texts.begin() + end);
+        classifier.predict_texts(batch, results.data());
+        for (size_t j = 0; j < batch.size(); ++j) write_result(out, results[j], batch[j]);
+    }
+}
+
+// The whole file, read once with getline
+static bool classify_file(const EmotionClassifier& classifier, const std::string& input, size_t batch_size,
+                          std::ostream& out) {
+    std::ifstream in(input);
+    if (!in) {
+        std::cerr << "ERROR: cannot open " << input << std::endl;
+        return false;
+    }
+    std::vector<std::string> texts;
+    std::string line;
+    for (;;) {
+        bool more = static_cast<bool>(std::getline(in, line));
+        if (more) {
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            if (!line.empty()) texts.push_back(std::move(line));
+        }
+        if (texts.size() == batch_size || (!more && !texts.empty())) {
+            classify_and_write(classifier, texts, batch_size, out);
+            texts.clear();
+        }
+        if (!more) break;
+    }
+    out.flush();
+    return true;
+}
+
+// 64-bit FNV-1a over the model files in model_dir and the options that change predictions,
+// so a checkpoint is only resumed with the model that produced its first chunks
+static uint64_t model_fingerprint(const std::string& model_dir, const ClassifierConfig& config) {
+    uint64_t h = 1469598103934665603ULL;
+    auto bytes = [&h](const void* data, size_t len) {
+        const unsigned char* p = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < len; ++i) {
+            h ^= p[i];
+            h *= 1099511628211ULL;
+        }
+    };
+    auto file = [&](const std::filesystem::path& path) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) return;
+        std::string name = path.lexically_relative(model_dir).generic_string();
+        bytes(name.data(), name.size() + 1);
+        std::vector<char> buffer(1 << 16);
+        while (in.read(buffer.data(), (std::streamsize)buffer.size()) || in.gcount() > 0)
+            bytes(buffer.data(), (size_t)in.gcount());
+    };
+
+    for (const char* name : {"VERSION", "word_index.txt", "labels.txt", "model.bundle", "frozen_model.pb", "cascade.bundle"})
+        file(std::filesystem::path(model_dir) / name);
+    std::error_code error;
+    std::vector<std::filesystem::path> saved_model;
+    for (std::filesystem::recursive_directory_iterator it(std::filesystem::path(model_dir) / "saved_model", error), end;
+         !error && it != end; it.increment(error))
+        if (it->is_regular_file()) saved_model.push_back(it->path());
+    std::sort(saved_model.begin(), saved_model.end());
+    for (const auto& path : saved_model) file(path);
+
+    int options[] = {(int)config.backend, (int)config.directions, (int)config.weights, config.max_len,
+                     (int)config.mode, (int)config.cascade};
+    bytes(options, sizeof(options));
+    bytes(&config.cascade_threshold, sizeof(config.cascade_threshold));
+    bytes(config.length_buckets.data(), config.length_buckets.size() * sizeof(int));
+    return h;
+}
+
+// Checkpointed run: classify chunk_lines input lines at a time and commit each chunk's
+// results before starting the next, skipping the chunks an earlier run already finished.
+// Chunk boundaries only depend on the input, so a resumed run produces the same chunks.
+static bool classify_chunks(const EmotionClassifier& classifier, const std::string& input, BatchCheckpoint& checkpoint,
+                            size_t chunk_lines, size_t batch_size) {
+    std::ifstream in(input, std::ios::binary);
+    if (!in) {
+        std::cerr << "ERROR: cannot open " << input << std::endl;
+        return false;
+    }
+    uint64_t offset = checkpoint.resume_offset();
+    if (offset) {
+        std::cerr << "[CHECKPOINT] resuming after chunk " << checkpoint.next_id() - 1 << " at byte " << offset
+                  << std::endl;
+        in.seekg((std::streamoff)offset);
+    }
+
+    std::vector<std::string> texts;
+    std::ostringstream results;
+    std::string line;
+    bool more = true;
+    while (more) {
+        BatchCheckpoint::Chunk chunk;
+        chunk.id = checkpoint.next_id();
+        chunk.begin = offset;
+        size_t lines = 0;
+        texts.clear();
+        while (lines < chunk_lines && (more = static_cast<bool>(std::getline(in, line)))) {
+            offset += line.size() + (in.eof() ? 0 : 1); // the last line may lack a line break
+            ++lines;
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            if (!line.empty()) texts.push_back(std::move(line));
+        }
+        if (lines == 0) break;
+        chunk.end = offset;
+        chunk.lines = texts.size();
+
+        results.str("");
+        classify_and_write(classifier, texts, batch_size, results);
+        if (!checkpoint.commit(chunk, results.str())) return false;
+        std::cerr << "[CHECKPOINT] chunk " << chunk.id << " done, input bytes " << chunk.begin << "-" << chunk.end
+                  << std::endl;
+    }
+    if (in.bad()) {
+        std::cerr << "ERROR: cannot read " << input << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Put the output together from the finished chunks: into output through a temporary file
+// and a rename, or onto stdout
+static bool assemble_output(const BatchCheckpoint& checkpoint, const std::string& output) {
+    if (output.empty()) return checkpoint.assemble(std::cout);
+    std::string tmp = output + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out || !checkpoint.assemble(out)) {
+            std::cerr << "ERROR: cannot write " << tmp << std::endl;
+            return false;
+        }
+    }
+    std::error_code error;
+    std::filesystem::rename(tmp, output, error);
+    if (error) {
+        std::cerr << "ERROR: cannot write " << output << ": " << error.message() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// The whole file through LineReader and ResultWriter: lines are views into the read buffers
+// until they are copied into the batch (whose strings keep their capacity from batch to
+// batch), and the output is formatted straight into the writer's buffers. Produces the
+// same bytes as classify_file.
+static bool classify_file_async(const EmotionClassifier& classifier, const std::string& input, size_t batch_size,
+                                IoBackend backend, int out_fd) {
+    LineReader reader(input, backend);
+    ResultWriter writer(out_fd, backend);
+    if (!reader.ok() || !writer.ok()) {
+        if (!reader.failed()) std::cerr << "ERROR: io_uring is not available" << std::endl;
+        return false;
+    }
+    std::cerr << "[BATCH] reading with " << reader.backend() << ", writing with " << writer.backend() << std::endl;
+
+    std::vector<std::string> batch(batch_size);
+    std::vector<PredictionResult> results(batch_size);
+    std::vector<std::string_view> lines;
+    size_t count = 0;
+    char confidence[32];
+    auto flush = [&]() {
+        batch.resize(count);
+        classifier.predict_texts(batch, results.data());
+        for (size_t i = 0; i < count; ++i) {
+            if (results[i].ok()) {
+                writer.append(results[i].label);
+                writer.append('\t');
+                // %g is what operator<< prints a float as by default
+                writer.append(confidence, (size_t)snprintf(confidence, sizeof(confidence), "%g",
+                                                           (double)results[i].confidence()));
+            } else {
+                writer.append("error\t0", 7);
+            }
+            writer.append('\t');
+            writer.append(batch[i]);
+            writer.append('\n');
+        }
+        batch.resize(batch_size);
+        count = 0;
+    };
+    while (reader.next(lines)) {
+        for (std::string_view line : lines) {
+            if (line.empty()) continue;
+            batch[count++].assign(line.data(), line.size());
+            if (count == batch_size) flush();
+        }
+    }
+    if (count > 0) flush();
+    return !reader.failed() && writer.finish();
+}
+
+// Offset file: "<inode> <offset>", replaced atomically so a crash never leaves half of it
+static void load_offset(const std::string& path, uint64_t& inode, uint64_t& offset) {
+    std::ifstream in(path);
+    if (!(in >> inode >> offset)) inode = offset = 0;
+}
+
+static bool save_offset(const std::string& path, uint64_t inode, uint64_t offset) {
+    std::string tmp = path + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::trunc);
+        out << inode << ' ' << offset << '\n';
+        if (!out.flush()) return false;
+    }
+    std::error_code error;
+    std::filesystem::rename(tmp, path, error);
+    return !error;
+}
+
+// Classify lines appended to input until SIGINT/SIGTERM. Lines are classified batch_size at
+// a time, as soon as a batch is full or its oldest line has waited max_delay. Reading stops
+// while a full batch is waiting, so a backlog is worked off batch by batch in bounded memory.
+// The results of a batch are flushed before the offset past it is saved, so a crash can
+// repeat a batch but never skip one.
+static bool follow_file(const ClassifierHost& host, const std::string& input, const std::string& offset_file,
+                        size_t batch_size, std::chrono::milliseconds max_delay, std::ostream& out) {
+    using Clock = std::chrono::steady_clock;
+    uint64_t inode = 0, offset = 0;
+    load_offset(offset_file, inode, offset);
+    if (offset) std::cerr << "[FOLLOW] resuming " << input << " at byte " << offset << std::endl;
+    LogFollower follower(input, offset, inode);
+
+    std::vector<LogFollower::Line> read;
+    std::deque<LogFollower::Line> pending;
+    std::vector<std::string> texts;
+    Clock::time_point oldest; // when the oldest pending line was read
+    uint64_t lines = 0, batches = 0;
+    double max_latency_ms = 0.0;
+    bool ok = true;
+    while (ok) {
+        bool stopping = stop_requested.load();
+        if (!stopping && pending.size() < batch_size) {
+            int timeout_ms = 1000;
+            if (!pending.empty()) {
+                auto left = std::chrono::duration_cast<std::chrono::milliseconds>(oldest + max_delay - Clock::now());
+                timeout_ms = (int)std::max<int64_t>(0, left.count());
+            }
+            ok = follower.poll(read, timeout_ms);
+            if (pending.empty() && !read.empty()) oldest = Clock::now();
+            std::move(read.begin(), read.end(), std::back_inserter(pending));
+            read.clear();
+        }
+        bool due = !pending.empty() &&
+                   (pending.size() >= batch_size || stopping || Clock::now() >= oldest + max_delay);
+        if (!due) {
+            if (stopping) break;
+            continue;
+        }
+
+        size_t count = std::min(batch_size, pending.size());
+        uint64_t end = pending[count - 1].end;
+        texts.clear();
+        for (size_t i = 0; i < count; ++i)
+            if (!pending[i].text.empty()) texts.push_back(std::move(pending[i].text));
+        pending.erase(pending.begin(), pending.begin() + count);
+        classify_and_write(*host.acquire(), texts, batch_size, out);
+        out.flush();
+        if (!save_offset(offset_file, follower.inode(), end))
+            std::cerr << "ERROR: cannot write " << offset_file << std::endl;
+        lines += texts.size();
+        ++batches;
+        max_latency_ms = std::max(max_latency_ms, std::chrono::duration<double, std::milli>(Clock::now() - oldest).count());
+    }
+    std::cerr << "[FOLLOW] " << lines << " lines in " << batches << " batches, longest wait " << max_latency_ms
+              << " ms, stopped at byte " << follower.offset() << std::endl;
+    return ok;
+}
+
+int main(int argc, char** argv) {
+    std::string input, output, offset_file, checkpoint_dir;
+    std::string model_dir = std::filesystem::current_path().string();
+    size_t batch_size = 64;
+    size_t chunk_lines = 10000;
+    bool follow = false;
+    bool restart = false;
+    std::string io = "auto";
+    int max_delay_ms = 200;
+    bool usage = false;
+    ClassifierConfig config;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--input" && i + 1 < argc) input = argv[++i];
+        else if (arg == "--output" && i + 1 < argc) output = argv[++i];
+        else if (arg == "--model-dir" && i + 1 < argc) model_dir = argv[++i];
+        else if (arg == "--batch" && i + 1 < argc) batch_size = std::max<size_t>(1, std::stoul(argv[++i]));
+        else if (arg == "--io" && i + 1 < argc) io = argv[++i];
+        else if (arg == "--follow") follow = true;
+        else if (arg == "--offset-file" && i + 1 < argc) offset_file = argv[++i];
+        else if (arg == "--max-delay-ms" && i + 1 < argc) max_delay_ms = std::max(0, std::stoi(argv[++i]));
+        else if (arg == "--checkpoint" && i + 1 < argc) checkpoint_dir = argv[++i];
+        else if (arg == "--chunk-lines" && i + 1 < argc) chunk_lines = std::max<size_t>(1, std::stoul(argv[++i]));
+        else if (arg == "--restart") restart = true;
+        else if (i + 1 < argc && parse_classifier_option(arg, argv[i + 1], config)) ++i;
+        else usage = true;
+    }
+    IoBackend io_backend = IoBackend::Auto;
+    bool stream_io = io == "stream";
+    if (!stream_io && !parse_io_backend(io, io_backend)) usage = true;
+    if (usage || input.empty() || (follow && !checkpoint_dir.empty())) {
+        std::cerr << "Usage: emotion_batch --input FILE [--output FILE] [--model-dir DIR] [--batch N]\n"
+                  << "                     [--io auto|uring|threads|stream] [--follow] [--offset-file FILE]\n"
+                  << "                     [--max-delay-ms N] [--checkpoint DIR] [--chunk-lines N] [--restart]\n"
+                  << "--follow and --checkpoint cannot be combined; a follower resumes from its offset file.\n"
+                  << kClassifierUsage << std::endl;
+        return 1;
+    }
+    if (offset_file.empty()) offset_file = input + ".offset";
+
+    ClassifierHost host(model_dir, config);
+    if (!host.load_initial()) return 1;
+
+    if (!checkpoint_dir.empty()) {
+        std::error_code error;
+        uint64_t input_size = std::filesystem::file_size(input, error);
+        if (error) {
+            std::cerr << "ERROR: cannot open " << input << ": " << error.message() << std::endl;
+            return 1;
+        }
+        char fingerprint[17];
+        snprintf(fingerprint, sizeof(fingerprint), "%016llx", (unsigned long long)model_fingerprint(model_dir, config));
+        std::string header = "emotion_batch checkpoint 1\n"
+                             "input " + std::filesystem::absolute(input).string() + " " + std::to_string(input_size) + "\n"
+                             "model " + fingerprint + "\n"
+                             "chunk_lines " + std::to_string(chunk_lines) + " batch " + std::to_string(batch_size) + "\n";
+        BatchCheckpoint checkpoint(checkpoint_dir);
+        if (!checkpoint.open(header, restart)) return 1;
+        if (!classify_chunks(*host.acquire(), input, checkpoint, chunk_lines, batch_size)) return 1;
+        if (!assemble_output(checkpoint, output)) return 1;
+        checkpoint.remove();
+        return 0;
+    }
+
+    if (!follow && !stream_io) {
+        std::cout.flush(); // the writer continues at fd 1's position, after anything buffered
+        int out_fd = STDOUT_FILENO;
+        if (!output.empty() && (out_fd = ::open(output.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644)) < 0) {
+            std::cerr << "ERROR: cannot write " << output << ": " << std::strerror(errno) << std::endl;
+            return 1;
+        }
+        bool ok = classify_file_async(*host.acquire(), input, batch_size, io_backend, out_fd);
+        if (out_fd != STDOUT_FILENO && close(out_fd) != 0) ok = false;
+        return ok ? 0 : 1;
+    }
+
+    std::ofstream file_out;
+    if (!output.empty()) {
+        file_out.open(output, follow ? std::ios::app : std::ios::trunc);
+        if (!file_out) {
+            std::cerr << "ERROR: cannot write " << output << std::endl;
+            return 1;
+        }
+    }
+    std::ostream& out = output.empty() ? std::cout : file_out;
+
+    if (!follow) return classify_file(*host.acquire(), input, batch_size, out) ? 0 : 1;
+
+    std::signal(SIGINT, on_stop_signal);
+    std::signal(SIGTERM, on_stop_signal);
+    host.start_watching(); // a long-running follower picks up retrained models too
+    return follow_file(host, input, offset_file, batch_size, std::chrono::milliseconds(max_delay_ms), out) ? 0 : 1;
+}
@@ -0,0 +1,95 @@
+// Allocation check for the native engine: once warmed up, a forward pass must not
+// touch the heap. Every global operator new is counted, on the calling thread and on
+// the direction helper thread alike; the run fails if a steady-state call allocates.
+// Threaded rows are skipped when the engine could not start a helper thread, since
+// they would only repeat the sequential run.
+// Usage: bench_arena [model.bundle] [iterations]
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "NativeEngine.h"
+#include "ScratchArena.h"
+
+static std::atomic<size_t> allocations{0};
+
+static void* counted_alloc(size_t size, size_t alignment) {
+    ++allocations;
+    size = size ? size : 1;
+#ifdef _MSC_VER
+    void* p = _aligned_malloc(size, alignment);
+#else
+    void* p = std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+#endif
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+static void counted_free(void* p) {
+#ifdef _MSC_VER
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+
+void* operator new(size_t size) { return counted_alloc(size, alignof(std::max_align_t)); }
+void* operator new[](size_t size) { return counted_alloc(size, alignof(std::max_align_t)); }
+void* operator new(size_t size, std::align_val_t a) { return counted_alloc(size, (size_t)a); }
+void* operator new[](size_t size, std::align_val_t a) { return counted_alloc(size, (size_t)a); }
+void operator delete(void* p) noexcept { counted_free(p); }
+void operator delete[](void* p) noexcept { counted_free(p); }
+void operator delete(void* p, size_t) noexcept { counted_free(p); }
+void operator delete[](void* p, size_t) noexcept { counted_free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { counted_free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { counted_free(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { counted_free(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept { counted_free(p); }
+
+int main(int argc, char** argv) {
+    const char* bundle = argc > 1 ? argv[1] : "model.bundle";
+    int iterations = argc > 2 ? std::atoi(argv[2]) : 20;
+    const int seq_len = 100;
+
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> ids(1, 50);
+    std::vector<float> tokens(64 * seq_len, 0.0f);
+    for (int b = 0; b < 64; ++b)
+        for (int t = 0; t < 5 + b % 40; ++t) tokens[(size_t)b * seq_len + t] = (float)ids(rng);
+
+    bool clean = true;
+    std::printf("%-12s %-6s %14s %12s %12s %12s\n", "directions", "batch", "allocs/call", "us/call", "arena KB",
+                "helper KB");
+    for (DirectionMode mode : {DirectionMode::Sequential, DirectionMode::Threaded}) {
+        NativeEngine engine(mode);
+        if (!engine.load(bundle)) return 1;
+        if (engine.direction_mode() != mode) {
+            std::printf("%-12s skipped: no helper thread (%u hardware threads), the engine runs sequential\n",
+                        "threaded", std::thread::hardware_concurrency());
+            continue;
+        }
+        for (int batch : {1, 8, 64}) {
+            std::vector<float> out;
+            engine.run(tokens.data(), batch, seq_len, out); // grows the arena and out
+            engine.run(tokens.data(), batch, seq_len, out);
+
+            size_t before = allocations.load();
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < iterations; ++i) engine.run(tokens.data(), batch, seq_len, out);
+            double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+            size_t count = allocations.load() - before;
+
+            const char* name = engine.direction_mode() == DirectionMode::Sequential ? "sequential" : "threaded";
+            std::printf("%-12s %-6d %14.2f %12.1f %12zu %12zu\n", name, batch, (double)count / iterations,
+                        us / iterations, ScratchArena::local().capacity() / 1024, engine.helper_arena_capacity() / 1024);
+            if (count) clean = false;
+        }
+    }
+    if (!clean) std::fprintf(stderr, "FAIL: steady-state inference allocated from the heap\n");
+    return clean ? 0 : 1;
+}
@@ -0,0 +1,194 @@
+// I/O throughput of emotion_batch without the model: every line of FILE is read and a
+// result line like emotion_batch's is written to FILE.out, once with getline/ostream
+// (--io stream) and once each with LineReader/ResultWriter on io_uring and on threads.
+// The input's pages are dropped from the page cache before every pass and the output is
+// synced before the clock stops, so a file smaller than RAM is measured like one larger.
+// --generate first writes SIZE_GB of random messages to FILE.
+// Usage: bench_batch_io FILE [--generate SIZE_GB] [--keep-output]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "BatchIO.h"
+
+namespace {
+
+const size_t kBatch = 64;
+
+// Random lines of 3 to 30 words, with the occasional empty line
+bool generate(const std::string& path, double gigabytes) {
+    static const char* const words[] = {"i",     "feel", "so",    "happy", "sad",   "today", "what",  "a",
+                                        "angry", "very", "scared", "love",  "this",  "day",   "never", "again"};
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> word(0, 15), length(3, 30);
+    std::string block;
+    uint64_t target = (uint64_t)(gigabytes * 1e9), written = 0;
+    while (out && written < target) {
+        block.clear();
+        while (block.size() < (1 << 20)) {
+            for (int n = length(rng) * (word(rng) != 0), i = 0; i < n; ++i) {
+                if (i) block += ' ';
+                block += words[word(rng)];
+            }
+            block += '\n';
+        }
+        out.write(block.data(), (std::streamsize)block.size());
+        written += block.size();
+    }
+    return static_cast<bool>(out.flush());
+}
+
+// Drop the file's pages from the page cache
+void evict(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return;
+    fdatasync(fd);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+}
+
+void sync_file(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return;
+    fdatasync(fd);
+    close(fd);
+}
+
+struct Pass {
+    uint64_t lines = 0;
+    uint64_t bytes_out = 0;
+    double seconds = 0.0;
+};
+
+// emotion_batch's classify_file, minus the model
+bool run_stream(const std::string& input, const std::string& output, Pass& pass) {
+    std::ifstream in(input);
+    std::ofstream out(output, std::ios::trunc);
+    std::vector<std::string> texts;
+    std::string line;
+    const float confidence = 0.4375f;
+    for (;;) {
+        bool more = static_cast<bool>(std::getline(in, line));
+        if (more) {
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            if (!line.empty()) texts.push_back(std::move(line));
+        }
+        if (texts.size() == kBatch || (!more && !texts.empty())) {
+            for (const std::string& text : texts) out << "joy" << '\t' << confidence << '\t' << text << '\n';
+            pass.lines += texts.size();
+            texts.clear();
+        }
+        if (!more) break;
+    }
+    return static_cast<bool>(out.flush()) && !in.bad();
+}
+
+// emotion_batch's classify_file_async, minus the model
+bool run_async(const std::string& input, const std::string& output, IoBackend backend, Pass& pass) {
+    int fd = ::open(output.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) return false;
+    bool ok;
+    {
+        LineReader reader(input, backend);
+        ResultWriter writer(fd, backend);
+        if (!reader.ok() || !writer.ok()) {
+            close(fd);
+            return false;
+        }
+        std::vector<std::string> batch(kBatch);
+        std::vector<std::string_view> lines;
+        size_t count = 0;
+        char confidence[32];
+        auto flush = [&]() {
+            for (size_t i = 0; i < count; ++i) {
+                writer.append("joy\t", 4);
+                writer.append(confidence, (size_t)snprintf(confidence, sizeof(confidence), "%g", 0.4375));
+                writer.append('\t');
+                writer.append(batch[i]);
+                writer.append('\n');
+            }
+            pass.lines += count;
+            count = 0;
+        };
+        while (reader.next(lines)) {
+            for (std::string_view line : lines) {
+                if (line.empty()) continue;
+                batch[count++].assign(line.data(), line.size());
+                if (count == kBatch) flush();
+            }
+        }
+        flush();
+        ok = !reader.failed() && writer.finish();
+    }
+    return close(fd) == 0 && ok;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: bench_batch_io FILE [--generate SIZE_GB] [--keep-output]" << std::endl;
+        return 1;
+    }
+    std::string input = argv[1], output = input + ".out";
+    bool keep_output = false;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--generate" && i + 1 < argc) {
+            double gigabytes = std::atof(argv[++i]);
+            std::cerr << "Writing " << gigabytes << " GB to " << input << std::endl;
+            if (!generate(input, gigabytes)) {
+                std::cerr << "ERROR: cannot write " << input << std::endl;
+                return 1;
+            }
+        } else if (arg == "--keep-output") {
+            keep_output = true;
+        }
+    }
+    std::ifstream probe(input, std::ios::binary | std::ios::ate);
+    if (!probe) {
+        std::cerr << "ERROR: cannot open " << input << std::endl;
+        return 1;
+    }
+    double input_mb = (double)probe.tellg() / 1e6;
+
+    std::printf("%-8s %12s %10s %10s %12s\n", "io", "lines", "seconds", "MB/s", "output MB");
+    uint64_t reference_bytes = 0;
+    bool ok = true;
+    for (const char* name : {"stream", "uring", "threads"}) {
+        evict(input);
+        std::remove(output.c_str());
+        Pass pass;
+        auto start = std::chrono::steady_clock::now();
+        bool done;
+        if (std::string(name) == "stream") done = run_stream(input, output, pass);
+        else done = run_async(input, output, name[0] == 'u' ? IoBackend::Uring : IoBackend::Threads, pass);
+        sync_file(output);
+        pass.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (!done) {
+            std::printf("%-8s failed or unavailable\n", name);
+            ok = false;
+            continue;
+        }
+        std::ifstream written(output, std::ios::binary | std::ios::ate);
+        pass.bytes_out = (uint64_t)written.tellg();
+        if (!reference_bytes) reference_bytes = pass.bytes_out;
+        std::printf("%-8s %12llu %10.2f %10.1f %12.1f%s\n", name, (unsigned long long)pass.lines, pass.seconds,
+                    input_mb / pass.seconds, pass.bytes_out / 1e6,
+                    pass.bytes_out == reference_bytes ? "" : "  (output size differs from stream)");
+        ok = ok && pass.bytes_out == reference_bytes;
+        evict(output);
+    }
+    if (!keep_output) std::remove(output.c_str());
+    return ok ? 0 : 1;
+}
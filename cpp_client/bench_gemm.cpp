@@ -0,0 +1,149 @@
+// Benchmark of the batched LSTM path: the packed-panel GEMM microkernel against a
+// naive loop for one recurrent step ([B, H] x [H, 4H]), then whole batched layers
+// against running one sequence at a time, as separate requests would.
+// Usage: bench_gemm [iterations]
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "GemmKernels.h"
+#include "LstmKernels.h"
+
+static const int kSteps = 100;
+
+static LstmWeights random_weights(int input_dim, int units, std::mt19937& rng) {
+    std::uniform_real_distribution<float> dist(-0.1f, 0.1f);
+    LstmWeights w;
+    w.input_dim = input_dim;
+    w.units = units;
+    w.kernel.resize((size_t)input_dim * 4 * units);
+    w.recurrent.resize((size_t)units * 4 * units);
+    w.bias.resize(4 * units);
+    for (float& v : w.kernel) v = dist(rng);
+    for (float& v : w.recurrent) v = dist(rng);
+    for (float& v : w.bias) v = dist(rng);
+    return w;
+}
+
+// Median microseconds of fn over iterations runs
+template <typename Fn>
+static double time_us(Fn fn, int iterations) {
+    fn();
+    std::vector<double> samples;
+    for (int i = 0; i < iterations; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        samples.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+    }
+    std::nth_element(samples.begin(), samples.begin() + samples.size() / 2, samples.end());
+    return samples[samples.size() / 2];
+}
+
+// c[b][j] = sum_r a[b][r] * w[r][j], straight from the Keras [H, 4H] layout
+static void naive_gemm(const float* a, int batch, int k, const float* w, int n, float* c) {
+    for (int b = 0; b < batch; ++b)
+        for (int j = 0; j < n; ++j) {
+            float sum = 0.0f;
+            for (int r = 0; r < k; ++r) sum += a[(size_t)b * k + r] * w[(size_t)r * n + j];
+            c[(size_t)b * n + j] = sum;
+        }
+}
+
+// Same product through the microkernel; c is in packed [b][tile][gate][lane] order
+static void packed_gemm(const float* a, int batch, const PackedLstm& p, float* c) {
+    const int gate_cols = p.tiles * kPanelWidth;
+    std::fill(c, c + (size_t)batch * gate_cols, 0.0f);
+    for (int tile = 0; tile < p.tiles; ++tile) {
+        const float* panel = p.panels.data() + (size_t)tile * p.units * kPanelWidth;
+        for (int b0 = 0; b0 < batch; b0 += kGemmRows)
+            gemm_panel(a + (size_t)b0 * p.units, p.units, std::min(kGemmRows, batch - b0), p.units, panel,
+                       c + (size_t)b0 * gate_cols + tile * kPanelWidth, gate_cols);
+    }
+}
+
+int main(int argc, char** argv) {
+    int iterations = argc > 1 ? std::atoi(argv[1]) : 20;
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+
+    std::printf("recurrent step GEMM [B, H] x [H, 4H], microkernel %d x %d\n", kGemmRows, kPanelWidth);
+    std::printf("%-6s %-6s %14s %14s %8s\n", "H", "B", "naive GFLOP/s", "packed GFLOP/s", "speedup");
+    for (int units : {128, 64}) {
+        LstmWeights w = random_weights(0, units, rng);
+        PackedLstm packed = pack_lstm(w);
+        for (int batch : {1, 8, 32, 128, 256}) {
+            std::vector<float> a((size_t)batch * units);
+            for (float& v : a) v = dist(rng);
+            std::vector<float> expected((size_t)batch * 4 * units), c((size_t)batch * packed.tiles * kPanelWidth);
+            naive_gemm(a.data(), batch, units, w.recurrent.data(), 4 * units, expected.data());
+            packed_gemm(a.data(), batch, packed, c.data());
+            // Packed column for gate g, unit u: tile u / kPackTile, lane u % kPackTile
+            for (int b = 0; b < batch; ++b)
+                for (int j = 0; j < 4 * units; ++j) {
+                    int g = j / units, u = j % units;
+                    float got = c[(size_t)b * packed.tiles * kPanelWidth + (u / kPackTile) * kPanelWidth +
+                                  g * kPackTile + u % kPackTile];
+                    if (std::abs(got - expected[(size_t)b * 4 * units + j]) > 1e-4f) {
+                        std::fprintf(stderr, "microkernel differs from the naive loop at H=%d B=%d\n", units, batch);
+                        return 1;
+                    }
+                }
+
+            double flops = 2.0 * batch * units * 4 * units;
+            double naive = time_us([&] { naive_gemm(a.data(), batch, units, w.recurrent.data(), 4 * units, expected.data()); },
+                                   iterations);
+            double fast = time_us([&] { packed_gemm(a.data(), batch, packed, c.data()); }, iterations);
+            std::printf("%-6d %-6d %14.2f %14.2f %7.2fx\n", units, batch, flops / naive / 1e3, flops / fast / 1e3,
+                        naive / fast);
+        }
+    }
+
+    std::printf("\nbidirectional layer, %d steps: us per sequence\n", kSteps);
+    std::printf("%-10s %-6s %14s %14s %8s\n", "layer", "B", "per-sequence", "batched", "speedup");
+    const int shapes[][2] = {{300, 128}, {256, 64}};
+    for (const auto& shape : shapes) {
+        int in = shape[0], units = shape[1];
+        PackedLstm fw = pack_lstm(random_weights(in, units, rng)), bw = pack_lstm(random_weights(in, units, rng));
+        for (int batch : {1, 8, 64}) {
+            std::vector<float> x((size_t)batch * kSteps * in);
+            for (float& v : x) v = dist(rng);
+            std::vector<float> out((size_t)batch * kSteps * 2 * units), expected(out.size());
+
+            auto per_sequence = [&](float* dst) {
+                for (int b = 0; b < batch; ++b) {
+                    const float* xb = x.data() + (size_t)b * kSteps * in;
+                    float* ob = dst + (size_t)b * kSteps * 2 * units;
+                    BatchedDirectionJob f = {&fw, xb, 1, kSteps, false, ob, 2 * units, nullptr, 0};
+                    BatchedDirectionJob r = {&bw, xb, 1, kSteps, true, ob + units, 2 * units, nullptr, 0};
+                    run_batched(f);
+                    run_batched(r);
+                }
+            };
+            auto batched = [&](float* dst) {
+                BatchedDirectionJob f = {&fw, x.data(), batch, kSteps, false, dst, 2 * units, nullptr, 0};
+                BatchedDirectionJob r = {&bw, x.data(), batch, kSteps, true, dst + units, 2 * units, nullptr, 0};
+                run_batched(f);
+                run_batched(r);
+            };
+            per_sequence(expected.data());
+            batched(out.data());
+            float max_diff = 0.0f;
+            for (size_t i = 0; i < out.size(); ++i) max_diff = std::max(max_diff, std::abs(out[i] - expected[i]));
+            if (max_diff > 1e-4f) {
+                std::fprintf(stderr, "batched layer differs from one sequence at a time by %g\n", max_diff);
+                return 1;
+            }
+
+            char name[32];
+            std::snprintf(name, sizeof(name), "%dx%d", in, units);
+            double seq_us = time_us([&] { per_sequence(expected.data()); }, iterations) / batch;
+            double batch_us = time_us([&] { batched(out.data()); }, iterations) / batch;
+            std::printf("%-10s %-6d %14.1f %14.1f %7.2fx\n", name, batch, seq_us, batch_us, seq_us / batch_us);
+        }
+    }
+    return 0;
+}
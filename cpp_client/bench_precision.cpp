@@ -0,0 +1,64 @@
+// Batched throughput and output drift of the native engine with fp32, fp16 and
+// bf16 weight storage, all loaded from the same bundle.
+// Usage: bench_precision [model.bundle] [iterations]
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "NativeEngine.h"
+
+int main(int argc, char** argv) {
+    const char* bundle = argc > 1 ? argv[1] : "model.bundle";
+    int iterations = argc > 2 ? std::atoi(argv[2]) : 5;
+    const int seq_len = 100, samples = 256;
+
+    // Token ids and lengths roughly like the dataset: mostly short, zero padded
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> ids(1, 4000), lengths(4, 40);
+    std::vector<float> tokens((size_t)samples * seq_len, 0.0f);
+    for (int b = 0; b < samples; ++b)
+        for (int t = 0, n = lengths(rng); t < n; ++t) tokens[(size_t)b * seq_len + t] = (float)ids(rng);
+
+    std::vector<float> reference;
+    int classes = 0;
+    std::printf("%-7s %10s %8s %12s %12s %12s\n", "weights", "MB", "batch", "seq/s", "max |dp|", "top-1 agree");
+    for (WeightType type : {WeightType::F32, WeightType::F16, WeightType::BF16}) {
+        NativeEngine engine(DirectionMode::Sequential, type);
+        if (!engine.load(bundle)) return 1;
+
+        std::vector<float> probs;
+        engine.run(tokens.data(), samples, seq_len, probs);
+        if (reference.empty()) {
+            reference = probs;
+            classes = (int)probs.size() / samples;
+        }
+        float max_diff = 0.0f;
+        int agree = 0;
+        for (int b = 0; b < samples; ++b) {
+            const float* p = &probs[(size_t)b * classes];
+            const float* r = &reference[(size_t)b * classes];
+            for (int j = 0; j < classes; ++j) max_diff = std::max(max_diff, std::abs(p[j] - r[j]));
+            agree += std::max_element(p, p + classes) - p == std::max_element(r, r + classes) - r;
+        }
+
+        for (int batch : {1, 8, 64, 256}) {
+            std::vector<double> rates;
+            for (int i = 0; i < iterations; ++i) {
+                auto start = std::chrono::steady_clock::now();
+                for (int b = 0; b + batch <= samples; b += batch)
+                    engine.run(tokens.data() + (size_t)b * seq_len, batch, seq_len, probs);
+                double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                rates.push_back(samples / seconds);
+            }
+            std::nth_element(rates.begin(), rates.begin() + rates.size() / 2, rates.end());
+            std::printf("%-7s %10.1f %8d %12.0f %12.2e %11.1f%%\n", weight_type_name(engine.weight_type()),
+                        engine.weight_bytes() / 1048576.0, batch, rates[rates.size() / 2], max_diff,
+                        100.0 * agree / samples);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,240 @@
+// Headless frame-time benchmark for the client UI. MainWindow is drawn into an ImGui
+// context with no platform or renderer backend: the display size and time step are
+// fixed, input is a scripted sequence of events, and ImGui::Render() only builds the
+// draw lists. Each scenario reports the UI thread's CPU time per frame, its heap
+// allocations per frame (operator new and ImGui's allocator) and the vertices produced.
+// Usage: bench_ui [model_dir] [frames_per_scenario] [bulk_lines]
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <new>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "imgui.h"
+#include "MainWindow.h"
+#include "Timing.h"
+
+// Only allocations made while a frame is being built on the UI thread are counted
+static thread_local bool counting = false;
+static size_t new_calls = 0, imgui_calls = 0;
+
+static void* counted_alloc(size_t size, size_t alignment) {
+    if (counting) ++new_calls;
+    size = size ? size : 1;
+#ifdef _MSC_VER
+    void* p = _aligned_malloc(size, alignment);
+#else
+    void* p = std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+#endif
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+static void counted_free(void* p) {
+#ifdef _MSC_VER
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+
+void* operator new(size_t size) { return counted_alloc(size, alignof(std::max_align_t)); }
+void* operator new[](size_t size) { return counted_alloc(size, alignof(std::max_align_t)); }
+void* operator new(size_t size, std::align_val_t a) { return counted_alloc(size, (size_t)a); }
+void* operator new[](size_t size, std::align_val_t a) { return counted_alloc(size, (size_t)a); }
+void operator delete(void* p) noexcept { counted_free(p); }
+void operator delete[](void* p) noexcept { counted_free(p); }
+void operator delete(void* p, size_t) noexcept { counted_free(p); }
+void operator delete[](void* p, size_t) noexcept { counted_free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { counted_free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { counted_free(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { counted_free(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept { counted_free(p); }
+
+static void* imgui_alloc(size_t size, void*) {
+    if (counting) ++imgui_calls;
+    return std::malloc(size);
+}
+
+static void imgui_free(void* p, void*) {
+    std::free(p);
+}
+
+static const ImVec2 kDisplaySize(900, 720);
+
+struct FrameStats {
+    std::vector<double> cpu_us;
+    size_t news = 0, imgui_allocs = 0, vertices = 0;
+};
+
+// One frame: apply this frame's scripted input, then build and "render" the UI
+static void frame(MainWindow& window, const std::function<void(ImGuiIO&)>& input, FrameStats* stats) {
+    ImGuiIO& io = ImGui::GetIO();
+    if (input) input(io);
+    size_t news = new_calls, imgui_allocs = imgui_calls;
+    counting = true;
+    double start = thread_cpu_seconds();
+    ImGui::NewFrame();
+    window.draw(BACKEND_READY, std::string());
+    ImGui::Render();
+    double cpu = thread_cpu_seconds() - start;
+    counting = false;
+    if (!stats) return;
+    stats->cpu_us.push_back(cpu * 1e6);
+    stats->news += new_calls - news;
+    stats->imgui_allocs += imgui_calls - imgui_allocs;
+    stats->vertices += ImGui::GetDrawData()->TotalVtxCount;
+}
+
+static void report(const char* scenario, FrameStats& stats) {
+    std::vector<double>& us = stats.cpu_us;
+    size_t n = us.size();
+    double mean = 0.0;
+    for (double v : us) mean += v;
+    mean /= n;
+    std::sort(us.begin(), us.end());
+    std::printf("%-12s %7zu %10.1f %10.1f %10.1f %10.2f %10.2f %10zu\n", scenario, n, mean, us[n / 2],
+                us[std::min(n - 1, n * 99 / 100)], (double)stats.news / n, (double)stats.imgui_allocs / n,
+                stats.vertices / n);
+}
+
+// Draw unmeasured frames (with real time passing, for the background threads) until done() holds
+static bool settle(MainWindow& window, const std::function<bool()>& done, double timeout_s) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::duration<double>(timeout_s);
+    while (!done()) {
+        if (std::chrono::steady_clock::now() > deadline) return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        frame(window, nullptr, nullptr);
+    }
+    frame(window, nullptr, nullptr);
+    return true;
+}
+
+static void click(ImGuiIO& io, ImVec2 pos) {
+    io.AddMousePosEvent(pos.x, pos.y);
+    io.AddMouseButtonEvent(0, true);
+    io.AddMouseButtonEvent(0, false);
+}
+
+static void select_all_and_delete(ImGuiIO& io) {
+    io.AddKeyEvent(ImGuiMod_Ctrl, true);
+    io.AddKeyEvent(ImGuiKey_A, true);
+    io.AddKeyEvent(ImGuiKey_A, false);
+    io.AddKeyEvent(ImGuiMod_Ctrl, false);
+    io.AddKeyEvent(ImGuiKey_Backspace, true);
+    io.AddKeyEvent(ImGuiKey_Backspace, false);
+}
+
+int main(int argc, char** argv) {
+    std::string model_dir = argc > 1 ? argv[1] : ".";
+    int frames = argc > 2 ? std::atoi(argv[2]) : 3000;
+    int bulk_lines = argc > 3 ? std::atoi(argv[3]) : 20000;
+    const std::string sentence = "I can't believe how wonderful this day turned out to be, thank you all so much! ";
+
+    ClassifierConfig config;
+    config.backend = Backend::Native;
+    ClassifierHost host(model_dir, config);
+    if (!host.load_initial()) return 1;
+    LivePredictor live_predictor(host);
+    BulkAnalyzer bulk_analyzer(host);
+
+    ImGui::SetAllocatorFunctions(imgui_alloc, imgui_free);
+    ImGui::CreateContext();
+    ImGuiIO& io = ImGui::GetIO();
+    io.IniFilename = nullptr;
+    io.DisplaySize = kDisplaySize;
+    io.DeltaTime = 1.0f / 60.0f;
+    io.Fonts->AddFontDefault();
+    std::string font_path = model_dir + "/comic.ttf";
+    ImFont* custom_font = std::ifstream(font_path).good() ? io.Fonts->AddFontFromFileTTF(font_path.c_str(), 28.0f) : nullptr;
+    io.FontGlobalScale = 1.3f;
+    io.Fonts->Build();
+
+    MainWindow window(host, live_predictor, bulk_analyzer);
+    window.custom_font = custom_font;
+    for (int i = 0; i < 10; ++i) frame(window, nullptr, nullptr); // first-use allocations and layout
+
+    std::printf("%-12s %7s %10s %10s %10s %10s %10s %10s\n", "scenario", "frames", "cpu us", "p50 us", "p99 us",
+                "new/frame", "imgui/frm", "vertices");
+
+    // Nothing happening but the animation
+    FrameStats idle;
+    for (int i = 0; i < frames; ++i) frame(window, nullptr, &idle);
+    report("idle", idle);
+
+    // Click the window, Tab into the text box and type at a brisk pace; the box is
+    // emptied whenever the sentence has been typed twice
+    frame(window, [](ImGuiIO& io) { click(io, ImVec2(kDisplaySize.x - 20, 20)); }, nullptr);
+    frame(window, [](ImGuiIO& io) {
+        io.AddKeyEvent(ImGuiKey_Tab, true);
+        io.AddKeyEvent(ImGuiKey_Tab, false);
+    }, nullptr);
+    settle(window, [&] { return io.WantTextInput; }, 1.0);
+    if (!io.WantTextInput) {
+        std::fprintf(stderr, "FAIL: the text box did not take keyboard focus\n");
+        return 1;
+    }
+    FrameStats typing;
+    size_t typed = 0;
+    for (int i = 0; i < frames; ++i) {
+        frame(window, [&](ImGuiIO& io) {
+            if (i % 3 != 0) return;
+            if (typed == 2 * sentence.size()) {
+                select_all_and_delete(io);
+                typed = 0;
+            } else {
+                io.AddInputCharacter((unsigned char)sentence[typed++ % sentence.size()]);
+            }
+        }, &typing);
+    }
+    report("typing", typing);
+
+    // A finished prediction on screen: label, probability bars and timings
+    frame(window, select_all_and_delete, nullptr);
+    for (int i = 0; i < 10; ++i) frame(window, nullptr, nullptr); // the queued key events trickle in one per frame
+    for (char c : sentence) frame(window, [c](ImGuiIO& io) { io.AddInputCharacter((unsigned char)c); }, nullptr);
+    if (!settle(window, [&] { return window.prediction().model_id && window.prediction().text == sentence; }, 10.0)) {
+        std::fprintf(stderr, "FAIL: no live prediction for the typed sentence\n");
+        return 1;
+    }
+    FrameStats predicted;
+    for (int i = 0; i < frames; ++i) frame(window, nullptr, &predicted);
+    report("prediction", predicted);
+
+    // The bulk results table, fully classified, scrolled down and back up with the wheel
+    std::string bulk_path = "bench_ui_bulk.txt";
+    {
+        const char* words[] = {"i", "feel", "happy", "sad", "angry", "so", "very", "today", "scared", "love", "what", "a", "day"};
+        std::mt19937 rng(42);
+        std::ofstream out(bulk_path);
+        for (int i = 0; i < bulk_lines; ++i) {
+            int n = 3 + (int)(rng() % 12);
+            for (int k = 0; k < n; ++k) out << (k ? " " : "") << words[rng() % 13];
+            out << '\n';
+        }
+    }
+    window.open_bulk(bulk_path);
+    bool classified = settle(window, [&] { return !bulk_analyzer.progress().running; }, 3600.0);
+    std::remove(bulk_path.c_str());
+    if (!classified || bulk_analyzer.progress().rows_done != (uint64_t)bulk_lines) {
+        std::fprintf(stderr, "FAIL: the bulk file was not fully classified\n");
+        return 1;
+    }
+    FrameStats table;
+    for (int i = 0; i < frames; ++i) {
+        frame(window, [&](ImGuiIO& io) {
+            io.AddMousePosEvent(kDisplaySize.x / 2, kDisplaySize.y - 60);
+            io.AddMouseWheelEvent(0.0f, i < frames / 2 ? -1.0f : 1.0f);
+        }, &table);
+    }
+    report("bulk table", table);
+
+    ImGui::DestroyContext();
+    return 0;
+}
@@ -0,0 +1,143 @@
+// Build-time generator for gui_main's embedded assets, run by CMake:
+//   embed_assets OUT.cpp [NAME PATH]...
+// word_index.txt becomes a prebuilt StaticVocabulary, labels.txt a list of strings and
+// every other file a byte array, so the GUI reads and parses none of them at startup.
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "StaticVocabulary.h"
+
+static bool read_file(const std::string& path, std::vector<unsigned char>& bytes) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+    bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    return true;
+}
+
+// Integers as a brace-initializer body, a fixed number per line
+template <typename T>
+static void write_values(std::ostream& out, const std::vector<T>& values) {
+    for (size_t i = 0; i < values.size(); ++i) {
+        out << (i % 24 == 0 ? "\n    " : "") << (unsigned long long)values[i] << ",";
+    }
+    if (values.empty()) out << "0"; // arrays may not be empty
+    out << "\n";
+}
+
+// C string literal; octal escapes keep the generated file plain ASCII
+static std::string quote(const std::string& text) {
+    std::string quoted = "\"";
+    for (unsigned char c : text) {
+        if (c == '"' || c == '\\') {
+            quoted += '\\';
+            quoted += (char)c;
+        } else if (c < 0x20 || c >= 0x7f || c == '?') {
+            char escape[8];
+            std::snprintf(escape, sizeof(escape), "\\%03o", c);
+            quoted += escape;
+        } else {
+            quoted += (char)c;
+        }
+    }
+    return quoted + "\"";
+}
+
+// Same parsing as TextPreprocessor: "word index" pairs, later duplicates win
+static void write_vocabulary(std::ostream& out, const std::vector<unsigned char>& bytes) {
+    std::map<std::string, int> words;
+    std::istringstream in(std::string(bytes.begin(), bytes.end()));
+    std::string word;
+    int index;
+    while (in >> word >> index) words[word] = index;
+
+    std::vector<unsigned char> chars;
+    std::vector<uint32_t> entries; // hash, offset, length, index per word
+    uint32_t slot_count = 1;
+    while (slot_count < words.size() * 2) slot_count *= 2; // load factor at most 1/2
+    std::vector<uint32_t> slots(slot_count, 0);
+    for (const auto& item : words) {
+        const std::string& text = item.first;
+        const uint32_t h = StaticVocabulary::hash(text.data(), text.size());
+        entries.insert(entries.end(), {h, (uint32_t)chars.size(), (uint32_t)text.size(), (uint32_t)item.second});
+        chars.insert(chars.end(), text.begin(), text.end());
+        uint32_t slot = h & (slot_count - 1);
+        while (slots[slot]) slot = (slot + 1) & (slot_count - 1);
+        slots[slot] = (uint32_t)(entries.size() / 4);
+    }
+
+    out << "static const uint32_t vocab_slots[] = {";
+    write_values(out, slots);
+    out << "};\nstatic const StaticVocabulary::Entry vocab_entries[] = {";
+    for (size_t i = 0; i < entries.size(); i += 4) {
+        out << "\n    {" << entries[i] << "u, " << entries[i + 1] << "u, " << entries[i + 2] << "u, "
+            << (int32_t)entries[i + 3] << "},";
+    }
+    if (entries.empty()) out << "{0, 0, 0, 0}";
+    out << "\n};\nstatic const unsigned char vocab_chars[] = {";
+    write_values(out, chars);
+    out << "};\nstatic const StaticVocabulary vocab = {vocab_slots, " << slot_count - 1 << "u, vocab_entries, "
+        << words.size() << "u, vocab_chars};\n";
+    out << "const StaticVocabulary* const kEmbeddedVocabulary = &vocab;\n\n";
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2 || argc % 2 != 0) {
+        std::cerr << "Usage: embed_assets OUT.cpp [NAME PATH]..." << std::endl;
+        return 1;
+    }
+
+    std::ostringstream out;
+    out << "// Generated by embed_assets from CMakeLists.txt; do not edit\n"
+        << "#include \"AssetLocator.h\"\n\n";
+    bool has_vocabulary = false, has_labels = false;
+    std::vector<std::pair<std::string, size_t>> files; // name and size of each byte array
+    for (int i = 2; i < argc; i += 2) {
+        const std::string name = argv[i], path = argv[i + 1];
+        std::vector<unsigned char> bytes;
+        if (!read_file(path, bytes)) {
+            std::cerr << "embed_assets: cannot read " << path << std::endl;
+            return 1;
+        }
+        if (name == "word_index.txt") {
+            write_vocabulary(out, bytes);
+            has_vocabulary = true;
+        } else if (name == "labels.txt") {
+            out << "const char* const kEmbeddedLabels[] = {\n";
+            std::istringstream lines(std::string(bytes.begin(), bytes.end()));
+            std::string line;
+            while (std::getline(lines, line)) {
+                if (!line.empty() && line.back() == '\r') line.pop_back();
+                if (!line.empty()) out << "    " << quote(line) << ",\n";
+            }
+            out << "    nullptr,\n};\n\n";
+            has_labels = true;
+        } else {
+            out << "static const unsigned char file_" << files.size() << "[] = {";
+            write_values(out, bytes);
+            out << "};\n\n";
+            files.emplace_back(name, bytes.size());
+        }
+    }
+    if (!has_vocabulary) out << "const StaticVocabulary* const kEmbeddedVocabulary = nullptr;\n\n";
+    if (!has_labels) out << "const char* const kEmbeddedLabels[] = {nullptr};\n\n";
+    out << "const EmbeddedFile kEmbeddedFiles[] = {\n";
+    for (size_t i = 0; i < files.size(); ++i)
+        out << "    {" << quote(files[i].first) << ", file_" << i << ", " << files[i].second << "},\n";
+    out << "    {nullptr, nullptr, 0},\n};\n";
+
+    const std::string text = out.str();
+    std::ofstream file(argv[1], std::ios::binary | std::ios::trunc);
+    if (!file.write(text.data(), (std::streamsize)text.size())) {
+        std::cerr << "embed_assets: cannot write " << argv[1] << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,96 @@
+// Offline evaluation on a labeled "text;emotion" file: accuracy and throughput of the
+// full model alone and behind the cascade, plus how often the cascade escalates.
+// Usage: emotion_eval --data val.txt [--model-dir DIR] [--batch N] [classifier options]
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "EmotionClassifier.h"
+
+struct EvalResult {
+    double accuracy;
+    double seconds;
+};
+
+// Classify every sequence in batches of batch_size and score against the labels
+static EvalResult evaluate(const EmotionClassifier& classifier, const std::vector<std::vector<float>>& sequences,
+                           const std::vector<std::string>& labels, size_t batch_size, bool use_cascade) {
+    size_t correct = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < sequences.size(); i += batch_size) {
+        size_t end = std::min(sequences.size(), i + batch_size);
+        std::vector<std::vector<float>> batch(sequences.begin() + i, sequences.begin() + end);
+        std::vector<std::string> predicted = classifier.classify_batch(batch, use_cascade);
+        for (size_t j = 0; j < predicted.size(); ++j) correct += predicted[j] == labels[i + j];
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return {sequences.empty() ? 0.0 : (double)correct / sequences.size(), seconds};
+}
+
+int main(int argc, char** argv) {
+    std::string data_path;
+    std::string model_dir = std::filesystem::current_path().string();
+    size_t batch_size = 64;
+    bool usage = false;
+    ClassifierConfig config;
+    config.cascade = true;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--data" && i + 1 < argc) data_path = argv[++i];
+        else if (arg == "--model-dir" && i + 1 < argc) model_dir = argv[++i];
+        else if (arg == "--batch" && i + 1 < argc) batch_size = std::max<size_t>(1, std::stoul(argv[++i]));
+        else if (i + 1 < argc && parse_classifier_option(arg, argv[i + 1], config)) ++i;
+        else usage = true;
+    }
+    if (usage || data_path.empty()) {
+        std::cerr << "Usage: emotion_eval --data FILE [--model-dir DIR] [--batch N]\n"
+                  << kClassifierUsage << std::endl;
+        return 1;
+    }
+
+    EmotionClassifier classifier(config);
+    if (!classifier.load(model_dir)) return 1;
+
+    std::ifstream in(data_path);
+    if (!in) {
+        std::cerr << "Error: cannot open " << data_path << std::endl;
+        return 1;
+    }
+    std::vector<std::vector<float>> sequences;
+    std::vector<std::string> labels;
+    std::string line;
+    while (std::getline(in, line)) {
+        size_t sep = line.rfind(';');
+        if (sep == std::string::npos) continue;
+        std::string label = line.substr(sep + 1);
+        while (!label.empty() && (label.back() == '\r' || label.back() == ' ')) label.pop_back();
+        sequences.push_back(classifier.preprocessor().preprocess(line.substr(0, sep)));
+        labels.push_back(label);
+    }
+    std::cout << "[EVAL] " << sequences.size() << " labeled sentences from " << data_path << std::endl;
+
+    // Warm once on everything so neither run pays first-call costs
+    evaluate(classifier, sequences, labels, batch_size, false);
+
+    EvalResult full = evaluate(classifier, sequences, labels, batch_size, false);
+    std::printf("%-8s %9s %12s %11s\n", "path", "accuracy", "sentences/s", "escalated");
+    std::printf("%-8s %8.2f%% %12.0f %10.1f%%\n", "full", 100.0 * full.accuracy,
+                sequences.size() / full.seconds, 100.0);
+    if (!classifier.has_cascade()) return 0;
+
+    EmotionClassifier::CascadeStats before = classifier.cascade_stats();
+    EvalResult cascade = evaluate(classifier, sequences, labels, batch_size, true);
+    EmotionClassifier::CascadeStats after = classifier.cascade_stats();
+    uint64_t seen = after.seen - before.seen, answered = after.answered - before.answered;
+    std::printf("%-8s %8.2f%% %12.0f %10.1f%%\n", "cascade", 100.0 * cascade.accuracy,
+                sequences.size() / cascade.seconds, seen ? 100.0 * (seen - answered) / seen : 0.0);
+    std::printf("speedup %.2fx, accuracy change %+.2f points\n", full.seconds / cascade.seconds,
+                100.0 * (cascade.accuracy - full.accuracy));
+    return 0;
+}
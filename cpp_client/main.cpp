@@ -3,72 +3,104 @@
 #include "imgui_impl_opengl3.h"
 #include "glfw3.h"
 #include "glfw3native.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <iostream>
 #include <string>
 #include <cstring> // for std::memcpy
 #include <filesystem>
+#include <memory>
+#include <thread>
 
 // Include your inference headers
-#include "TextPreprocessor.h"
-#include "LabelUtils.h"
-
-// Include TensorFlow C API
-#include "tensorflow/c/c_api.h"
-
-// Include STB image for texture loading
-#define STB_IMAGE_IMPLEMENTATION
-#include "stb_image.h"
-
-// Forward declare your inference function
-std::string predict_emotion(const std::string& text);
+#include "AssetLocator.h"
+#include "ClassifierHost.h"
+#include "FontAtlasCache.h"
+#include "LivePredictor.h"
+#include "MainWindow.h"
+#include "TFLoader.h"
+#include "Timing.h"
 
 // Helper to get base directory (where executable is run)
 std::string get_base_dir() {
     return std::filesystem::current_path().string();
 }
 
-GLuint LoadTextureFromFile(const char* filename) {
-    int w, h, channels;
-    unsigned char* data = stbi_load(filename, &w, &h, &channels, 4);
-    if (!data) return 0;
+// Upload a packed atlas as one texture
+GLuint UploadAtlas(const ImageAtlas& atlas) {
     GLuint tex;
     glGenTextures(1, &tex);
     glBindTexture(GL_TEXTURE_2D, tex);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, atlas.width(), atlas.height(), 0, GL_RGBA, GL_UNSIGNED_BYTE, atlas.pixels());
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    stbi_image_free(data);
     return tex;
 }
 
-void ImGuiTextShadow(const ImVec4& color, const char* fmt, ...) {
-    va_list args;
-    va_start(args, fmt);
-    ImVec2 pos = ImGui::GetCursorScreenPos();
-    ImDrawList* draw_list = ImGui::GetWindowDrawList();
-    char buf[512];
-    vsnprintf(buf, sizeof(buf), fmt, args);
-    va_end(args);
-
-    // Draw shadow (black, slightly offset)
-    draw_list->AddText(ImGui::GetFont(), ImGui::GetFontSize(), ImVec2(pos.x+2, pos.y+2), IM_COL32(0,0,0,180), buf);
-    // Draw main text
-    draw_list->AddText(ImGui::GetFont(), ImGui::GetFontSize(), pos, ImGui::ColorConvertFloat4ToU32(color), buf);
-
-    // Move cursor as if text was drawn
-    ImGui::Dummy(ImGui::CalcTextSize(buf));
+// Decides when the main loop draws. Idle, it sleeps in glfwWaitEventsTimeout. An input
+// event or a posted wake-up (glfwPostEmptyEvent, e.g. a finished prediction) is followed
+// by a few back-to-back frames so ImGui can settle hover and focus changes. Animation,
+// when enabled, is drawn at a capped rate instead of as fast as the GPU allows.
+struct FramePacer {
+    static constexpr int kSettleFrames = 3;
+    static constexpr double kIdleTimeout = 0.5; // keeps tooltips and the text cursor blink going
+    bool animate = true;                        // Herta's bounce and the title color
+    double animation_fps = 30.0;
+    int settle = kSettleFrames;                 // frames left to draw without waiting
+
+    // Block until the next frame is due, processing window events meanwhile
+    void wait() {
+        if (settle > 0) {
+            --settle;
+            glfwPollEvents();
+            return;
+        }
+        double timeout = animate ? 1.0 / animation_fps : kIdleTimeout;
+        double start = glfwGetTime();
+        glfwWaitEventsTimeout(timeout);
+        if (glfwGetTime() - start < 0.9 * timeout) settle = kSettleFrames; // an event, not the timer
+    }
+};
+
+// Loaded on a background thread once the first frame is up (see BackendState)
+std::atomic<int> backend_state{BACKEND_LOADING};
+std::string backend_error; // written before backend_state becomes BACKEND_FAILED
+std::unique_ptr<ClassifierHost> model_host; // swaps in retrained models while the client runs
+std::unique_ptr<LivePredictor> live_predictor; // predicts in the background while the user types
+std::unique_ptr<BulkAnalyzer> bulk_analyzer;   // classifies dropped files in the background
+
+// Path of a file dropped on the window, picked up by the next frame. Only the path is
+// handled here; reading and classifying the file happen on bulk_analyzer's threads.
+std::string dropped_path;
+void on_file_drop(GLFWwindow*, int count, const char** paths) {
+    if (count > 0) dropped_path = paths[0];
 }
 
-enum HertaState { WELCOME, THINKING, HAPPY, SAD, ANGRY, FEAR };
-HertaState herta_state = WELCOME;
-
-int main() {
+int main(int argc, char** argv) {
     std::string base_dir = get_base_dir();
+    FramePacer pacer;
+    bool font_cache = true;
+    std::string asset_dir; // files here replace the ones built into the executable
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--no-animation") == 0) pacer.animate = false;
+        if (std::strcmp(argv[i], "--no-font-cache") == 0) font_cache = false;
+        if (std::strcmp(argv[i], "--asset-dir") == 0 && i + 1 < argc) asset_dir = argv[++i];
+    }
+    AssetLocator assets(asset_dir, base_dir);
 
     // Setup window
     if (!glfwInit()) return 1;
     GLFWwindow* window = glfwCreateWindow(600, 400, "Emotion Classifier - Dear ImGui", NULL, NULL);
+
+    // Decode Herta's faces (in HertaState order) while the GL context, ImGui and the font
+    // come up; they are uploaded as one atlas texture once the first frame is on screen
+    ImageAtlas herta_atlas;
+    herta_atlas.load_async({assets.find("Herta.png"), assets.find("Herta thinkling.png"), assets.find("Herta happy.png"),
+                            assets.find("Herta sad.png"), assets.find("Herta angry.png"), assets.find("Herta fear.png")},
+                           [] { glfwPostEmptyEvent(); });
     glfwMakeContextCurrent(window);
+    glfwSwapInterval(1); // never draw faster than the display refreshes
     IMGUI_CHECKVERSION();
     ImGui::CreateContext();
     ImGui_ImplGlfw_InitForOpenGL(window, true);
@@ -77,129 +109,75 @@ int main() {
     // Setup font
     ImGuiIO& io = ImGui::GetIO();
     io.Fonts->AddFontDefault(); // Keep default for fallback
-    ImFont* customFont = io.Fonts->AddFontFromFileTTF((base_dir + "/comic.ttf").c_str(), 28.0f);
-    io.FontGlobalScale = 1.3f;
-
-    static char input[256] = "";
-    static std::string result = "";
-
-    // ---- Load texture ONCE, after OpenGL context is ready ----
-    GLuint herta_welcome  = LoadTextureFromFile((base_dir + "/Herta.png").c_str());
-    GLuint herta_thinking = LoadTextureFromFile((base_dir + "/Herta thinkling.png").c_str());
-    GLuint herta_happy    = LoadTextureFromFile((base_dir + "/Herta happy.png").c_str());
-    GLuint herta_sad      = LoadTextureFromFile((base_dir + "/Herta sad.png").c_str());
-    GLuint herta_angry    = LoadTextureFromFile((base_dir + "/Herta angry.png").c_str());
-    GLuint herta_fear     = LoadTextureFromFile((base_dir + "/Herta fear.png").c_str());
-    if (herta_welcome == 0 || herta_thinking == 0 || herta_happy == 0 ||
-        herta_sad == 0 || herta_angry == 0 || herta_fear == 0) {
-        std::cerr << "Failed to load one or more Herta textures!" << std::endl;
+    Asset comic = assets.find("comic.ttf");
+    ImFont* customFont = nullptr;
+    if (comic.data) {
+        ImFontConfig font_config;
+        font_config.FontDataOwnedByAtlas = false; // static data inside the executable
+        customFont = io.Fonts->AddFontFromMemoryTTF(const_cast<unsigned char*>(comic.data), (int)comic.size, 28.0f, &font_config);
+    } else {
+        customFont = io.Fonts->AddFontFromFileTTF(comic.path.c_str(), 28.0f);
     }
-    // ---------------------------------------------------------
+    io.FontGlobalScale = 1.3f;
 
+    // Bake the atlas up front, reusing the one saved by the last run if the fonts are unchanged
+    auto font_start = std::chrono::steady_clock::now();
+    bool font_cached = build_font_atlas(io.Fonts, font_cache ? base_dir + "/font_atlas.cache" : std::string());
+    std::cout << "[TIMING] font atlas " << (font_cached ? "loaded from cache" : "rasterized") << " in "
+              << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - font_start).count()
+              << " ms" << std::endl;
+
+    GLuint herta_texture = 0; // the atlas, once uploaded
+
+    // The model itself stays in base_dir; vocabulary and labels come with the executable
+    ClassifierConfig config;
+    config.preprocessor = assets.preprocessor(config.max_len);
+    config.labels = assets.labels();
+    model_host.reset(new ClassifierHost(base_dir, config));
+    live_predictor.reset(new LivePredictor(*model_host, std::chrono::milliseconds(150), [] { glfwPostEmptyEvent(); }));
+    bulk_analyzer.reset(new BulkAnalyzer(*model_host, 2, 128, [] { glfwPostEmptyEvent(); }));
+    MainWindow main_window(*model_host, *live_predictor, *bulk_analyzer);
+    main_window.custom_font = customFont;
+    main_window.animate = pacer.animate;
+    main_window.on_result = [] { glfwPostEmptyEvent(); };
+    glfwSetDropCallback(window, on_file_drop);
+    std::thread backend_loader;
+    // Frame rate and CPU use are reported at exit, counted from when loading finished
+    bool measuring = false;
+    long frames = 0;
+    double loop_start = 0.0, loop_cpu = 0.0;
     while (!glfwWindowShouldClose(window)) {
-        glfwPollEvents();
+        pacer.animate = main_window.animate;
+        pacer.wait();
+        // The loader thread starts right after the first frame, so this never delays it
+        if (herta_texture == 0 && backend_loader.joinable() && herta_atlas.ready()) {
+            herta_texture = UploadAtlas(herta_atlas);
+            main_window.herta_texture = (ImTextureID)(intptr_t)herta_texture;
+            main_window.herta_atlas = &herta_atlas;
+            herta_atlas.release_pixels();
+            std::cout << "[TIMING] Herta images decoded and packed in " << herta_atlas.build_ms() << " ms ("
+                      << herta_atlas.width() << "x" << herta_atlas.height() << " atlas), uploaded at "
+                      << ms_since_process_start() << " ms" << std::endl;
+        }
+        if (!measuring && backend_state.load() != BACKEND_LOADING) {
+            measuring = true;
+            loop_start = glfwGetTime();
+            loop_cpu = process_cpu_seconds();
+        }
+        frames += measuring;
         ImGui_ImplOpenGL3_NewFrame();
         ImGui_ImplGlfw_NewFrame();
         ImGui::NewFrame();
 
-        // Gradient background
-        ImDrawList* draw_list = ImGui::GetBackgroundDrawList();
-        ImVec2 size = ImGui::GetIO().DisplaySize;
-        draw_list->AddRectFilledMultiColor(
-            ImVec2(0, 0), size,
-            IM_COL32(40, 40, 80, 255),   // Top-left color
-            IM_COL32(80, 80, 160, 255),  // Top-right color
-            IM_COL32(30, 30, 60, 255),   // Bottom-right color
-            IM_COL32(10, 10, 30, 255)    // Bottom-left color
-        );
-
-        // Fullscreen window
-        ImVec2 display_size = ImGui::GetIO().DisplaySize;
-        ImGui::SetNextWindowPos(ImVec2(0, 0), ImGuiCond_Always);
-        ImGui::SetNextWindowSize(display_size, ImGuiCond_Always);
-
-        ImGui::PushStyleVar(ImGuiStyleVar_WindowRounding, 18.0f);
-        ImGui::PushStyleColor(ImGuiCol_WindowBg, IM_COL32(30, 30, 40, 220));
-        ImGui::Begin("Emotion Classifier", nullptr, ImGuiWindowFlags_AlwaysAutoResize);
-
-        // Herta image selection
-        GLuint current_herta = herta_welcome;
-        if (herta_state == THINKING) current_herta = herta_thinking;
-        else if (herta_state == HAPPY) current_herta = herta_happy;
-        else if (herta_state == SAD) current_herta = herta_sad;
-        else if (herta_state == ANGRY) current_herta = herta_angry;
-        else if (herta_state == FEAR) current_herta = herta_fear;
-
-        ImGui::Columns(2, nullptr, false); // 2 columns, no border
-
-        // --- Left column: Herta image ---
-        ImGui::SetColumnWidth(0, 270); // Enough for 256px image + padding
-        float t = ImGui::GetTime();
-        float bounce = 10.0f * sinf(t * 2.5f);
-        ImVec2 herta_pos = ImGui::GetCursorScreenPos();
-        ImGui::SetCursorScreenPos(ImVec2(herta_pos.x, herta_pos.y + bounce));
-        ImGui::Image((ImTextureID)current_herta, ImVec2(256, 256));
-        ImGui::SetCursorScreenPos(herta_pos); // Reset for next widgets
-
-        ImGui::NextColumn();
-
-        // --- Right column: UI ---
-        ImVec4 animatedColor = ImVec4(0.4f + 0.2f*sinf(t*2), 0.7f, 1.0f, 1.0f);
-        ImGuiTextShadow(animatedColor, "Hello, I am Herta!");
-        ImGui::TextWrapped("I was made by Sitanshu and Yash for a semester project.\nKeep in mind that I am just a semester project and I can make mistakes.");
-        ImGui::Separator();
-        ImGui::Spacing();
-
-        ImGui::Text("Enter text for emotion classification:");
-
-        // Clamp input box width to 400px max
-        ImVec2 input_box_size = ImVec2(400, 80);
-        ImGui::PushStyleColor(ImGuiCol_FrameBg, IM_COL32(10, 10, 30, 255));
-        ImGui::PushStyleColor(ImGuiCol_Text, IM_COL32(255, 255, 255, 255));
-        if (ImGui::InputTextMultiline("##input", input, IM_ARRAYSIZE(input), input_box_size)) {
-            if (strlen(input) == 0)
-                herta_state = WELCOME;
-            else
-                herta_state = THINKING;
-        }
-        ImGui::PopStyleColor(2);
-        ImGui::SameLine();
-        if (ImGui::Button("Clear")) {
-            input[0] = '\0';
-            result.clear();
-            herta_state = WELCOME;
-        }
-        ImGui::Spacing();
-
-        ImGui::PushFont(customFont);
-        if (ImGui::Button("Predict", ImVec2(180, 0))) {
-            result = predict_emotion(input);
-            if (result == "joy") herta_state = HAPPY;
-            else if (result == "sadness") herta_state = SAD;
-            else if (result == "anger") herta_state = ANGRY;
-            else if (result == "fear") herta_state = FEAR;
-            else herta_state = WELCOME;
-        }
-        ImGui::SameLine();
-        if (ImGui::IsItemHovered())
-            ImGui::SetTooltip("Click to predict the emotion of the entered text.");
-        ImGui::PopFont();
-
-        ImGui::Spacing();
-
-        if (!result.empty()) {
-            if (result == "error") {
-                ImGuiTextShadow(ImVec4(1.0f, 0.2f, 0.2f, 1.0f), "Prediction failed, please try again.");
-            } else {
-                ImGuiTextShadow(ImVec4(0.2f, 0.8f, 0.2f, 1.0f), "Predicted emotion: %s", result.c_str());
-            }
+        // A dropped file goes to the results table below the input
+        if (!dropped_path.empty()) {
+            main_window.open_bulk(dropped_path);
+            dropped_path.clear();
+            int window_w, window_h; // make room for the results table
+            glfwGetWindowSize(window, &window_w, &window_h);
+            if (window_h < 720) glfwSetWindowSize(window, std::max(window_w, 900), 720);
         }
-
-        ImGui::Columns(1); // End columns
-
-        ImGui::End();
-        ImGui::PopStyleColor();
-        ImGui::PopStyleVar();
+        main_window.draw((BackendState)backend_state.load(), backend_error);
 
         ImGui::Render();
         int display_w, display_h;
@@ -209,8 +187,42 @@ int main() {
         glClear(GL_COLOR_BUFFER_BIT);
         ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
         glfwSwapBuffers(window);
+
+        // First frame is on screen: report it and start loading the model
+        if (!backend_loader.joinable()) {
+            std::cout << "[TIMING] first frame at " << ms_since_process_start() << " ms" << std::endl;
+            backend_loader = std::thread([base_dir]() {
+                std::string error;
+                if (!tf_load_library(&error)) {
+                    // error already describes the missing library
+                } else if (!model_host->load_initial()) {
+                    error = "Could not load the model from " + base_dir + ".";
+                }
+                if (error.empty()) {
+                    model_host->start_watching();
+                    backend_state = BACKEND_READY;
+                    std::cout << "[TIMING] ready at " << ms_since_process_start() << " ms" << std::endl;
+                } else {
+                    std::cerr << "ERROR: " << error << std::endl;
+                    backend_error = error;
+                    backend_state = BACKEND_FAILED;
+                }
+                glfwPostEmptyEvent(); // redraw now that the Predict button's state changed
+            });
+        }
     }
+    if (measuring) {
+        double seconds = glfwGetTime() - loop_start, cpu = process_cpu_seconds() - loop_cpu;
+        std::cout << "[FRAMES] " << frames << " frames in " << seconds << " s (" << frames / seconds
+                  << "/s), CPU " << 100.0 * cpu / seconds << "% of one core" << std::endl;
+    }
+    if (backend_loader.joinable()) backend_loader.join();
+    bulk_analyzer.reset();
+    live_predictor.reset();
+    model_host.reset();
 
+    herta_atlas.wait(); // its ready callback must not outlive GLFW
+    if (herta_texture) glDeleteTextures(1, &herta_texture);
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
     ImGui::DestroyContext();
@@ -219,103 +231,3 @@ int main() {
     return 0;
 }
 
-// Implement this function using your inference code
-std::string predict_emotion(const std::string& text) {
-    std::cout << "[DEBUG] ENTERED predict_emotion()" << std::endl;
-
-    std::string base_dir = get_base_dir();
-
-    std::string export_dir = base_dir + "/saved_model";
-    const char* tag = "serve";
-    const char* input_name = "serving_default_keras_tensor";
-    const char* output_name = "StatefulPartitionedCall_1";
-    int input_dim = 100;
-
-    // Initialize text preprocessor with vocab file
-    std::string vocab_path = base_dir + "/word_index.txt";
-    TextPreprocessor preprocessor(vocab_path, input_dim);
-
-    // Load label file
-    std::string label_path = base_dir + "/labels.txt";
-    std::vector<std::string> labels = load_labels(label_path);
-
-    // Preprocess the input text
-    std::vector<float> input_vals = preprocessor.preprocess(text);
-
-    std::cout << "[DEBUG] Preprocessed input, size: " << input_vals.size() << std::endl;
-
-    TF_Status* status = TF_NewStatus();
-    TF_Graph* graph = TF_NewGraph();
-    TF_SessionOptions* opts = TF_NewSessionOptions();
-    TF_Session* sess = nullptr;
-
-    // Load the TensorFlow model
-    {
-        std::cout << "[DEBUG] Loading SavedModel..." << std::endl;
-        sess = TF_LoadSessionFromSavedModel(opts, nullptr, export_dir.c_str(), &tag, 1, graph, nullptr, status);
-
-        if (TF_GetCode(status) != TF_OK) {
-            std::cerr << "ERROR loading model: " << TF_Message(status) << std::endl;
-            TF_DeleteStatus(status);
-            return "error";
-        }
-        std::cout << "Model loaded successfully!" << std::endl;
-    }
-
-    TF_Output input_op = {TF_GraphOperationByName(graph, input_name), 0};
-    TF_Output output_op = {TF_GraphOperationByName(graph, output_name), 0};
-
-    // Create input tensor
-    TF_Tensor* input_tensor = TF_AllocateTensor(TF_FLOAT, (const int64_t[]){1, input_dim}, 2, sizeof(float) * input_dim);
-    std::memcpy(TF_TensorData(input_tensor), input_vals.data(), sizeof(float) * input_dim);
-
-    TF_Tensor* output_tensor = nullptr;
-
-    // Run inference
-    {
-        TF_SessionRun(sess,
-                      nullptr,
-                      &input_op, &input_tensor, 1,
-                      &output_op, &output_tensor, 1,
-                      nullptr, 0,
-                      nullptr,
-                      status);
-
-        if (TF_GetCode(status) != TF_OK) {
-            std::cerr << "ERROR during inference: " << TF_Message(status) << std::endl;
-            TF_DeleteTensor(input_tensor);
-            TF_DeleteStatus(status);
-            return "error";
-        }
-    }
-
-    // Process output
-    std::string result;
-    {
-        auto data = static_cast<float*>(TF_TensorData(output_tensor));
-        size_t output_elements = TF_TensorByteSize(output_tensor) / sizeof(float);
-
-        // --- PRINT PREDICTED EMOTION LABEL ---
-        if (output_elements == labels.size()) {
-            size_t pred = argmax(data, output_elements);
-            result = labels[pred];
-        } else {
-            std::cerr << "Warning: Output size (" << output_elements
-                      << ") does not match number of labels (" << labels.size() << ")." << std::endl;
-            result = "error";
-        }
-        // -------------------------------------
-    }
-
-    // Cleanup
-    TF_DeleteTensor(input_tensor);
-    TF_DeleteTensor(output_tensor);
-    TF_CloseSession(sess, status);
-    TF_DeleteSession(sess, status);
-    TF_DeleteGraph(graph);
-    TF_DeleteSessionOptions(opts);
-    TF_DeleteStatus(status);
-
-    std::cout << "[DEBUG] Exiting predict_emotion()" << std::endl;
-    return result;
-}
\ No newline at end of file
@@ -0,0 +1,348 @@
+// Router: consistent-hashes requests onto inference workers so each worker's
+// prediction cache sees a stable slice of the input space.
+//
+// Client protocol (one request per line):
+//   PING               -> PONG
+//   PREDICT <text>     -> forwarded reply from a worker, or ERR <message>
+//   JOIN <host:port>   -> OK       (add a worker; it serves once it reports READY)
+//   LEAVE <host:port>  -> OK       (remove a worker; its keys move to ring neighbours)
+//   STATUS             -> OK <endpoint>=up|down:<replies> ... requests=N hedged=M refused=K
+//
+// Calls to workers run on a fixed pool (--attempt-threads); when all of its threads are
+// busy and as many calls wait, a request is answered ERR router busy and hedges are skipped.
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+
+#include "HashRing.h"
+#include "NetUtils.h"
+#include "TextPreprocessor.h"
+
+using Clock = std::chrono::steady_clock;
+
+// One worker process and its pool of idle connections
+struct Backend {
+    std::string endpoint;
+    std::string host;
+    int port = 0;
+    std::atomic<bool> healthy{false};
+    std::atomic<long long> replies{0}; // successful PREDICT replies
+    std::mutex pool_mutex;
+    std::vector<std::unique_ptr<LineSocket>> idle;
+};
+
+// Fixed set of threads that make the worker calls of hedged requests. At most threads
+// calls run and as many wait; beyond that submit() refuses, so a burst of slow workers
+// cannot pile up threads.
+class AttemptPool {
+public:
+    explicit AttemptPool(size_t threads) : max_queued_(threads) {
+        for (size_t i = 0; i < threads; ++i) threads_.emplace_back(&AttemptPool::run, this);
+    }
+    ~AttemptPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+        for (std::thread& thread : threads_) thread.join();
+    }
+
+    AttemptPool(const AttemptPool&) = delete;
+    AttemptPool& operator=(const AttemptPool&) = delete;
+
+    bool submit(std::function<void()> job) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (queue_.size() >= max_queued_) return false;
+            queue_.push_back(std::move(job));
+        }
+        wake_.notify_one();
+        return true;
+    }
+
+private:
+    size_t max_queued_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::deque<std::function<void()>> queue_;
+    bool stop_ = false;
+    std::vector<std::thread> threads_;
+
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (;;) {
+            wake_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+            if (stop_) return; // jobs still queued belong to requests nobody waits for any more
+            std::function<void()> job = std::move(queue_.front());
+            queue_.pop_front();
+            lock.unlock();
+            job();
+            lock.lock();
+        }
+    }
+};
+
+class Router {
+public:
+    Router(const TextPreprocessor& preprocessor, int hedge_ms, int timeout_ms, int attempt_threads)
+        : preprocessor_(preprocessor), hedge_ms_(hedge_ms), timeout_ms_(timeout_ms), attempts_(attempt_threads) {}
+
+    bool join(const std::string& endpoint);
+    void leave(const std::string& endpoint);
+    void health_loop(int interval_ms);
+    std::string route(const std::string& text);
+    std::string status();
+
+private:
+    const TextPreprocessor& preprocessor_;
+    int hedge_ms_;
+    int timeout_ms_;
+
+    std::mutex mutex_; // guards ring_ and backends_
+    HashRing ring_;
+    std::map<std::string, std::shared_ptr<Backend>> backends_;
+
+    std::atomic<long long> requests_{0};
+    std::atomic<long long> hedged_{0};
+    std::atomic<long long> refused_{0};
+
+    AttemptPool attempts_; // last, so it stops before the state its calls use goes away
+
+    bool call(Backend& backend, const std::string& request, std::string& reply, int timeout_ms);
+    bool probe(Backend& backend);
+    void set_health(const std::shared_ptr<Backend>& backend, bool healthy);
+};
+
+// Send one request, reusing a pooled connection when possible
+bool Router::call(Backend& backend, const std::string& request, std::string& reply, int timeout_ms) {
+    std::unique_ptr<LineSocket> sock;
+    {
+        std::lock_guard<std::mutex> lock(backend.pool_mutex);
+        if (!backend.idle.empty()) {
+            sock = std::move(backend.idle.back());
+            backend.idle.pop_back();
+        }
+    }
+    if (!sock) {
+        int fd = connect_tcp(backend.host, backend.port, timeout_ms);
+        if (fd < 0) return false;
+        sock.reset(new LineSocket(fd));
+    }
+    if (!sock->send_line(request) || !sock->recv_line(reply, timeout_ms))
+        return false; // connection state unknown, drop it
+
+    std::lock_guard<std::mutex> lock(backend.pool_mutex);
+    backend.idle.push_back(std::move(sock));
+    return true;
+}
+
+// A worker is healthy once it has loaded and warmed up its model
+bool Router::probe(Backend& backend) {
+    std::string reply;
+    return call(backend, "READY", reply, timeout_ms_) && reply == "READY";
+}
+
+// Flip a backend in or out of the ring when its health changes
+void Router::set_health(const std::shared_ptr<Backend>& backend, bool healthy) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (backends_.find(backend->endpoint) == backends_.end()) return; // left meanwhile
+    if (backend->healthy.exchange(healthy) == healthy) return;
+    if (healthy) ring_.add_node(backend->endpoint);
+    else ring_.remove_node(backend->endpoint);
+    std::cout << "[ROUTER] " << backend->endpoint << (healthy ? " up" : " down")
+              << ", ring has " << ring_.size() << " worker(s)" << std::endl;
+}
+
+// Register a worker and probe it immediately
+bool Router::join(const std::string& endpoint) {
+    auto backend = std::make_shared<Backend>();
+    backend->endpoint = endpoint;
+    if (!parse_endpoint(endpoint, backend->host, backend->port)) return false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (backends_.count(endpoint)) return true;
+        backends_[endpoint] = backend;
+    }
+    set_health(backend, probe(*backend));
+    return true;
+}
+
+// Deregister a worker; only the keys it owned move
+void Router::leave(const std::string& endpoint) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ring_.remove_node(endpoint);
+    backends_.erase(endpoint);
+    std::cout << "[ROUTER] " << endpoint << " left, ring has " << ring_.size() << " worker(s)" << std::endl;
+}
+
+// Periodically probe every registered worker
+void Router::health_loop(int interval_ms) {
+    for (;;) {
+        std::vector<std::shared_ptr<Backend>> snapshot;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (auto& kv : backends_) snapshot.push_back(kv.second);
+        }
+        for (auto& backend : snapshot)
+            set_health(backend, probe(*backend));
+        std::this_thread::sleep_for(std::chrono::milliseconds(interval_ms));
+    }
+}
+
+// Shared by all attempts of one hedged request
+struct HedgeState {
+    std::mutex m;
+    std::condition_variable cv;
+    int pending = 0;
+    bool done = false;
+    std::string reply;
+};
+
+// Route to the key's owner; if it has not answered within hedge_ms, also ask the next ring node
+std::string Router::route(const std::string& text) {
+    ++requests_;
+    std::vector<float> seq = preprocessor_.preprocess(text);
+    std::vector<int32_t> tokens(seq.begin(), seq.end());
+    uint64_t key = HashRing::hash_bytes(tokens.data(), tokens.size() * sizeof(int32_t));
+
+    std::vector<std::shared_ptr<Backend>> candidates;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& endpoint : ring_.lookup(key, 3))
+            candidates.push_back(backends_[endpoint]);
+    }
+    if (candidates.empty()) return "ERR no healthy workers";
+
+    auto state = std::make_shared<HedgeState>();
+    std::string request = "PREDICT " + text;
+    int timeout_ms = timeout_ms_;
+    // False if the pool is saturated; the attempt is then not made
+    auto launch = [&](const std::shared_ptr<Backend>& backend) {
+        bool queued = attempts_.submit([this, state, backend, request, timeout_ms]() {
+            std::string reply;
+            bool ok = call(*backend, request, reply, timeout_ms) && reply.compare(0, 3, "OK ") == 0;
+            if (ok) ++backend->replies;
+            std::lock_guard<std::mutex> lock(state->m);
+            --state->pending;
+            if (ok && !state->done) {
+                state->done = true;
+                state->reply = reply;
+            }
+            state->cv.notify_all();
+        });
+        if (queued) ++state->pending; // caller holds state->m, so the job cannot finish first
+        else ++refused_;
+        return queued;
+    };
+
+    auto deadline = Clock::now() + std::chrono::milliseconds(timeout_ms_);
+    std::unique_lock<std::mutex> lock(state->m);
+    size_t next = 0;
+    if (!launch(candidates[next++])) return "ERR router busy";
+    auto last_launch = Clock::now();
+
+    while (!state->done && Clock::now() < deadline) {
+        bool can_launch = next < candidates.size();
+        if (state->pending == 0) {
+            if (!can_launch || !launch(candidates[next++])) break; // every attempt failed: fail over right away
+            last_launch = Clock::now();
+            continue;
+        }
+        auto wake = deadline;
+        if (can_launch) wake = std::min(deadline, last_launch + std::chrono::milliseconds(hedge_ms_));
+        if (state->cv.wait_until(lock, wake) == std::cv_status::timeout && can_launch && Clock::now() < deadline) {
+            // A saturated pool means the workers are slow everywhere; a hedge would only add load
+            if (launch(candidates[next])) ++hedged_;
+            ++next;
+            last_launch = Clock::now();
+        }
+    }
+    return state->done ? state->reply : "ERR all workers failed";
+}
+
+std::string Router::status() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::string out = "OK";
+    for (auto& kv : backends_)
+        out += " " + kv.first + (kv.second->healthy ? "=up:" : "=down:") + std::to_string(kv.second->replies.load());
+    out += " requests=" + std::to_string(requests_.load());
+    out += " hedged=" + std::to_string(hedged_.load());
+    out += " refused=" + std::to_string(refused_.load());
+    return out;
+}
+
+// Serve one client connection until it disconnects
+static void serve_client(int fd, Router& router) {
+    LineSocket sock(fd);
+    std::string line;
+    while (sock.recv_line(line)) {
+        if (line == "PING") sock.send_line("PONG");
+        else if (line.compare(0, 8, "PREDICT ") == 0) sock.send_line(router.route(line.substr(8)));
+        else if (line.compare(0, 5, "JOIN ") == 0) sock.send_line(router.join(line.substr(5)) ? "OK" : "ERR bad endpoint");
+        else if (line.compare(0, 6, "LEAVE ") == 0) { router.leave(line.substr(6)); sock.send_line("OK"); }
+        else if (line == "STATUS") sock.send_line(router.status());
+        else sock.send_line("ERR unknown command");
+    }
+}
+
+int main(int argc, char** argv) {
+    int port = 9000;
+    int hedge_ms = 50;
+    int timeout_ms = 2000;
+    int health_ms = 1000;
+    int attempt_threads = 64;
+    std::string vocab_path = std::filesystem::current_path().string() + "/word_index.txt";
+    std::vector<std::string> workers;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--port" && i + 1 < argc) port = std::stoi(argv[++i]);
+        else if (arg == "--worker" && i + 1 < argc) workers.push_back(argv[++i]);
+        else if (arg == "--vocab" && i + 1 < argc) vocab_path = argv[++i];
+        else if (arg == "--hedge-ms" && i + 1 < argc) hedge_ms = std::stoi(argv[++i]);
+        else if (arg == "--timeout-ms" && i + 1 < argc) timeout_ms = std::stoi(argv[++i]);
+        else if (arg == "--health-ms" && i + 1 < argc) health_ms = std::stoi(argv[++i]);
+        else if (arg == "--attempt-threads" && i + 1 < argc) attempt_threads = std::max(1, std::stoi(argv[++i]));
+        else {
+            std::cerr << "Usage: emotion_router [--port N] [--worker HOST:PORT]... [--vocab FILE]\n"
+                         "                      [--hedge-ms N] [--timeout-ms N] [--health-ms N]\n"
+                         "                      [--attempt-threads N]" << std::endl;
+            return 1;
+        }
+    }
+    std::signal(SIGPIPE, SIG_IGN);
+
+    TextPreprocessor preprocessor(vocab_path);
+    Router router(preprocessor, hedge_ms, timeout_ms, attempt_threads);
+    for (const auto& w : workers) {
+        if (!router.join(w)) std::cerr << "Ignoring bad worker endpoint: " << w << std::endl;
+    }
+    std::thread(&Router::health_loop, &router, health_ms).detach();
+
+    int listen_fd = listen_tcp(port);
+    if (listen_fd < 0) {
+        std::cerr << "ERROR: cannot listen on port " << port << std::endl;
+        return 1;
+    }
+    std::cout << "[ROUTER] listening on port " << port << std::endl;
+
+    for (;;) {
+        int fd = ::accept(listen_fd, nullptr, nullptr);
+        if (fd < 0) continue;
+        std::thread(serve_client, fd, std::ref(router)).detach();
+    }
+}
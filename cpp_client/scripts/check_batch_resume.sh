@@ -0,0 +1,70 @@
+#!/usr/bin/env bash
+# Kill-and-resume check for emotion_batch --checkpoint: an uninterrupted run and a run that
+# is SIGKILLed several times mid-way and then resumed must produce byte-identical output.
+# The generated input has CRLF lines, a run of blank lines longer than a whole chunk (so
+# one chunk has no output at all) and a last line without a line break.
+# Usage: scripts/check_batch_resume.sh BUILD_DIR MODEL_DIR [classifier options...]
+#        e.g. scripts/check_batch_resume.sh build ../python_ml_server/model --backend native
+set -u
+
+if [ $# -lt 2 ]; then
+    sed -n '2,7p' "$0" | sed 's/^# \{0,1\}//'
+    exit 2
+fi
+batch="$1/emotion_batch"
+model_dir="$2"
+shift 2
+if [ ! -x "$batch" ]; then
+    echo "FAIL: $batch not found; build the emotion_batch target first"
+    exit 2
+fi
+
+work=$(mktemp -d)
+trap 'kill -9 $(jobs -p) 2>/dev/null; rm -rf "$work"' EXIT
+input="$work/input.txt"
+chunk_lines=40
+
+words=(i feel so happy sad today what a angry very scared love this day never again)
+{
+    for ((n = 0; n < 600; ++n)) {
+        line=""
+        for ((w = 0; w < 3 + n % 17; ++w)) { line+="${words[(n * 7 + w * 3) % 16]} "; }
+        if ((n % 29 == 0)); then printf '%s\r\n' "$line"; else printf '%s\n' "$line"; fi
+        if ((n == 200)); then for ((b = 0; b < 3 * chunk_lines; ++b)) { printf '\n'; }; fi
+    }
+    printf 'the last line has no line break'
+} > "$input"
+
+run() { "$batch" --input "$input" --model-dir "$model_dir" "$@" 2>>"$work/log"; }
+
+if ! run --output "$work/expected.tsv" "${@}"; then
+    echo "FAIL: uninterrupted run failed"; cat "$work/log"; exit 1
+fi
+
+# Kill the checkpointed run once the manifest lists at least the given number of chunks
+checkpoint="$work/checkpoint"
+args=(--output "$work/resumed.tsv" --checkpoint "$checkpoint" --chunk-lines "$chunk_lines" "$@")
+for after in 2 5 6 11; do
+    "$batch" --input "$input" --model-dir "$model_dir" "${args[@]}" 2>>"$work/log" &
+    pid=$!
+    while kill -0 "$pid" 2>/dev/null; do
+        done_chunks=$(grep -c '^chunk' "$checkpoint/manifest" 2>/dev/null)
+        if [ "${done_chunks:-0}" -ge "$after" ]; then kill -9 "$pid"; break; fi
+        sleep 0.02
+    done
+    wait "$pid" 2>/dev/null
+    echo "killed after $(grep -c '^chunk' "$checkpoint/manifest" 2>/dev/null || echo 0) chunks"
+done
+if ! run "${args[@]}"; then
+    echo "FAIL: resumed run failed"; cat "$work/log"; exit 1
+fi
+
+if ! cmp "$work/expected.tsv" "$work/resumed.tsv"; then
+    echo "FAIL: resumed output differs from the uninterrupted run"
+    exit 1
+fi
+if [ -e "$checkpoint" ]; then
+    echo "FAIL: checkpoint directory left behind after a finished run"
+    exit 1
+fi
+echo "OK: $(wc -l < "$work/expected.tsv") result lines identical after resuming"
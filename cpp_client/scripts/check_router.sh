@@ -0,0 +1,117 @@
+#!/usr/bin/env bash
+# Stickiness and failover check for emotion_router: starts three emotion_workers and a router,
+# checks that every text always lands on the same worker, kills the worker owning one text
+# and checks that its requests still succeed on another worker, then restarts it and checks
+# that the text moves back. Worker replies are counted per worker by the router's STATUS.
+# Usage: scripts/check_router.sh BUILD_DIR MODEL_DIR [classifier options...]
+#        e.g. scripts/check_router.sh build ../python_ml_server/model --backend native
+set -u
+
+if [ $# -lt 2 ]; then
+    sed -n '2,7p' "$0" | sed 's/^# \{0,1\}//'
+    exit 2
+fi
+build="$1"
+model_dir="$2"
+shift 2
+for tool in emotion_worker emotion_router; do
+    if [ ! -x "$build/$tool" ]; then
+        echo "FAIL: $build/$tool not found; build the $tool target first"
+        exit 2
+    fi
+done
+
+work=$(mktemp -d)
+trap '{ kill -9 $(jobs -p); wait; } 2>/dev/null; rm -rf "$work"' EXIT
+router_port=$((20000 + RANDOM % 20000))
+ports=($((router_port + 1)) $((router_port + 2)) $((router_port + 3)))
+declare -A pid
+
+start_worker() {
+    "$build/emotion_worker" --port "$1" --model-dir "$model_dir" "${worker_args[@]}" >>"$work/worker-$1.log" 2>&1 &
+    pid[$1]=$!
+}
+# To stderr, so the message also shows when it ends a $(owner ...)
+fail() {
+    echo "FAIL: $*" >&2
+    tail -n 5 "$work"/*.log >&2
+    exit 1
+}
+
+# One command to the router, one reply line back
+ask() {
+    { exec 3<>"/dev/tcp/127.0.0.1/$router_port"; } 2>/dev/null || return 1
+    printf '%s\n' "$1" >&3
+    IFS= read -r -t 30 reply <&3
+    exec 3<&-
+    printf '%s' "$reply"
+}
+
+# Successful replies of worker port so far, from STATUS
+replies() { ask STATUS | sed -n "s/.* 127\.0\.0\.1:$1=[a-z]*:\([0-9]*\).*/\1/p"; }
+
+# Wait until STATUS shows worker port as up or down
+wait_for() {
+    for ((i = 0; i < 600; ++i)) {
+        if ask STATUS | grep -q " 127\.0\.0\.1:$1=$2:"; then return 0; fi
+        sleep 0.2
+    }
+    fail "worker $1 never went $2"
+}
+
+# Send text n times; prints the one port that answered all of them
+owner() {
+    local text="$1" n="$2" before=() port delta answered=""
+    for port in "${ports[@]}"; do before+=("$(replies "$port")"); done
+    for ((k = 0; k < n; ++k)) {
+        reply=$(ask "PREDICT $text")
+        [[ "$reply" == "OK "* ]] || fail "PREDICT $text answered '$reply'"
+    }
+    for i in "${!ports[@]}"; do
+        delta=$(($(replies "${ports[i]}") - ${before[i]:-0}))
+        if ((delta == n)); then
+            answered="${ports[i]}"
+        elif ((delta != 0)); then
+            fail "'$text' went to several workers"
+        fi
+    done
+    [ -n "$answered" ] || fail "no single worker answered '$text'"
+    echo "$answered"
+}
+
+worker_args=("$@")
+for port in "${ports[@]}"; do start_worker "$port"; done
+# Hedging would send one text to two workers; this check is about ownership alone
+"$build/emotion_router" --port "$router_port" --vocab "$model_dir/word_index.txt" --hedge-ms 10000 \
+    --timeout-ms 20000 --health-ms 200 $(for port in "${ports[@]}"; do echo --worker "127.0.0.1:$port"; done) \
+    >>"$work/router.log" 2>&1 &
+for port in "${ports[@]}"; do wait_for "$port" up; done
+
+texts=("i feel so happy today" "what a sad day" "i am very angry" "this scares me"
+       "i love this" "never again" "i feel nothing at all" "so happy and so sad")
+declare -A owners
+for text in "${texts[@]}"; do owners["$text"]=$(owner "$text" 4) || exit 1; done
+if [ "$(printf '%s\n' "${owners[@]}" | sort -u | wc -l)" -lt 2 ]; then
+    fail "all texts went to one worker"
+fi
+echo "sticky: ${#texts[@]} texts, each always on the same worker"
+
+# Failover: the owner's pooled connection breaks, so the router retries on the next worker
+victim_text="${texts[0]}"
+victim="${owners[$victim_text]}"
+{ kill -9 "${pid[$victim]}"; wait "${pid[$victim]}"; } 2>/dev/null
+survivor=$(owner "$victim_text" 1) || exit 1
+[ "$survivor" != "$victim" ] || fail "a killed worker answered"
+wait_for "$victim" down
+[ "$(owner "$victim_text" 3)" = "$survivor" ] || fail "'$victim_text' did not stay on $survivor"
+for text in "${texts[@]}"; do
+    if [ "${owners[$text]}" != "$victim" ] && [ "$(owner "$text" 1)" != "${owners[$text]}" ]; then
+        fail "'$text' moved although its worker is up"
+    fi
+done
+echo "failover: worker $victim killed, its texts served by $survivor, other texts unmoved"
+
+start_worker "$victim"
+wait_for "$victim" up
+[ "$(owner "$victim_text" 2)" = "$victim" ] || fail "'$victim_text' did not move back to $victim"
+echo "OK: worker $victim restarted and owns its texts again"
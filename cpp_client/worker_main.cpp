@@ -0,0 +1,137 @@
+// Inference worker: keeps one model resident and answers line-based requests over TCP.
+//
+// Protocol (one request per line):
+//   PING            -> PONG                (liveness)
+//   READY           -> READY | NOT_READY   (model loaded and warmed up)
+//   PREDICT <text>  -> OK <label> | ERR <message>
+#include <atomic>
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <list>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <filesystem>
+#include <sys/socket.h>
+
+#include "ClassifierHost.h"
+#include "NetUtils.h"
+#include "Timing.h"
+
+// Small LRU cache keyed by the normalized token sequence
+class PredictionCache {
+public:
+    explicit PredictionCache(size_t capacity) : capacity_(capacity) {}
+
+    bool get(const std::string& key, std::string& label) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = index_.find(key);
+        if (it == index_.end()) return false;
+        entries_.splice(entries_.begin(), entries_, it->second);
+        label = it->second->second;
+        return true;
+    }
+
+    void put(const std::string& key, const std::string& label) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (capacity_ == 0 || index_.count(key)) return;
+        entries_.emplace_front(key, label);
+        index_[key] = entries_.begin();
+        if (entries_.size() > capacity_) {
+            index_.erase(entries_.back().first);
+            entries_.pop_back();
+        }
+    }
+
+private:
+    size_t capacity_;
+    std::mutex mutex_;
+    std::list<std::pair<std::string, std::string>> entries_;
+    std::unordered_map<std::string, std::list<std::pair<std::string, std::string>>::iterator> index_;
+};
+
+// The model is loaded in the background so the port answers PING/READY right away
+static std::atomic<bool> ready{false};
+
+// Serve one client connection until it disconnects
+static void serve_client(int fd, const ClassifierHost& host, PredictionCache& cache) {
+    LineSocket sock(fd);
+    std::string line;
+    while (sock.recv_line(line)) {
+        if (line == "PING") {
+            sock.send_line("PONG");
+        } else if (line == "READY") {
+            sock.send_line(ready ? "READY" : "NOT_READY");
+        } else if (line.compare(0, 8, "PREDICT ") == 0 && !ready) {
+            sock.send_line("ERR not ready");
+        } else if (line.compare(0, 8, "PREDICT ") == 0) {
+            // Finish on this snapshot even if a hot reload swaps models meanwhile
+            std::shared_ptr<const EmotionClassifier> classifier = host.acquire();
+            std::vector<float> seq = classifier->preprocessor().preprocess(line.substr(8));
+            std::string key = classifier->version() + '\0' +
+                std::string(reinterpret_cast<const char*>(seq.data()), seq.size() * sizeof(float));
+            std::string label;
+            if (!cache.get(key, label)) {
+                PredictionResult result;
+                classifier->predict_batch({seq}, &result);
+                if (!result.ok()) {
+                    sock.send_line("ERR inference failed");
+                    continue;
+                }
+                label = std::string(result.label);
+                cache.put(key, label);
+            }
+            sock.send_line("OK " + label);
+        } else {
+            sock.send_line("ERR unknown command");
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    int port = 9100;
+    size_t cache_size = 10000;
+    std::string model_dir = std::filesystem::current_path().string();
+    ClassifierConfig config;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--port" && i + 1 < argc) port = std::stoi(argv[++i]);
+        else if (arg == "--model-dir" && i + 1 < argc) model_dir = argv[++i];
+        else if (arg == "--cache-size" && i + 1 < argc) cache_size = std::stoul(argv[++i]);
+        else if (i + 1 < argc && parse_classifier_option(arg, argv[i + 1], config)) ++i;
+        else {
+            std::cerr << "Usage: emotion_worker [--port N] [--model-dir DIR] [--cache-size N]\n"
+                      << kClassifierUsage << std::endl;
+            return 1;
+        }
+    }
+    std::signal(SIGPIPE, SIG_IGN);
+
+    ClassifierHost host(model_dir, config);
+    PredictionCache cache(cache_size);
+    std::thread([&host]() {
+        if (!host.load_initial()) {
+            std::cerr << "ERROR: worker could not load and warm up the model" << std::endl;
+            std::exit(1);
+        }
+        host.start_watching();
+        ready = true;
+        std::cout << "[WORKER] ready after " << ms_since_process_start() << " ms" << std::endl;
+    }).detach();
+
+    int listen_fd = listen_tcp(port);
+    if (listen_fd < 0) {
+        std::cerr << "ERROR: cannot listen on port " << port << std::endl;
+        return 1;
+    }
+    std::cout << "[WORKER] listening on port " << port << std::endl;
+
+    for (;;) {
+        int fd = ::accept(listen_fd, nullptr, nullptr);
+        if (fd < 0) continue;
+        std::thread(serve_client, fd, std::cref(host), std::ref(cache)).detach();
+    }
+}
@@ -0,0 +1,66 @@
+import os
+import pickle
+import time
+import numpy as np
+import pandas as pd
+import tensorflow as tf
+from tensorflow.keras.preprocessing.sequence import pad_sequences
+from model_variants import LENGTH_BUCKETS, bucket_for, clone_for_inference
+
+# Paths
+DATA_PATH = os.path.join("python_ml_server", "data", "test.txt")
+MODEL_PATH = os.path.join("python_ml_server", "model", "model.keras")
+TOKENIZER_PATH = os.path.join("python_ml_server", "model", "tokenizer.pkl")
+LABEL_ENCODER_PATH = os.path.join("python_ml_server", "model", "label_encoder.pkl")
+
+# Parameters
+MAX_LEN = 100
+
+# Compare exact (padded to MAX_LEN), bucketed and masked execution on the labeled dataset
+print("Loading model, tokenizer and dataset...")
+model = tf.keras.models.load_model(MODEL_PATH)
+with open(TOKENIZER_PATH, "rb") as f:
+    tokenizer = pickle.load(f)
+with open(LABEL_ENCODER_PATH, "rb") as f:
+    label_encoder = pickle.load(f)
+data = pd.read_csv(DATA_PATH, sep=";", names=["text", "emotion"])
+labels = label_encoder.transform(data["emotion"])
+sequences = [seq[:MAX_LEN] for seq in tokenizer.texts_to_sequences(data["text"])]
+lengths = np.array([max(1, len(seq)) for seq in sequences])
+
+dynamic = clone_for_inference(model)
+masked = clone_for_inference(model, mask_zero=True)
+
+
+def predict_exact(m):
+    return np.argmax(m.predict(pad_sequences(sequences, maxlen=MAX_LEN, padding="post"), verbose=0), axis=1)
+
+
+def predict_bucketed(m):
+    preds = np.zeros(len(sequences), dtype=int)
+    for bucket in LENGTH_BUCKETS:
+        idx = [i for i, n in enumerate(lengths) if bucket_for(n) == bucket]
+        if idx:
+            batch = pad_sequences([sequences[i] for i in idx], maxlen=bucket, padding="post")
+            preds[idx] = np.argmax(m.predict(batch, verbose=0), axis=1)
+    return preds
+
+
+steps_exact = len(sequences) * MAX_LEN
+steps_bucketed = sum(bucket_for(n) for n in lengths)
+print(f"Records: {len(sequences)}, mean length {lengths.mean():.1f} tokens, "
+      f"{100 * (lengths <= 16).mean():.0f}% fit in 16 steps")
+print(f"Timesteps: exact {steps_exact}, bucketed {steps_bucketed} "
+      f"({100 * (1 - steps_bucketed / steps_exact):.0f}% fewer)\n")
+
+baseline = None
+print(f"{'mode':<22}{'accuracy':>10}{'agrees w/ exact':>17}{'seconds':>10}")
+for name, run in [("exact (padded 100)", lambda: predict_exact(model)),
+                  ("bucketed", lambda: predict_bucketed(dynamic)),
+                  ("bucketed + masked", lambda: predict_bucketed(masked))]:
+    start = time.perf_counter()
+    preds = run()
+    seconds = time.perf_counter() - start
+    if baseline is None:
+        baseline = preds
+    print(f"{name:<22}{(preds == labels).mean():>10.4f}{(preds == baseline).mean():>17.4f}{seconds:>10.2f}")
@@ -0,0 +1,45 @@
+import os
+import pickle
+import time
+import numpy as np
+import pandas as pd
+import tensorflow as tf
+from tensorflow.keras.preprocessing.sequence import pad_sequences
+from model_variants import WEIGHT_DTYPES, with_weight_dtype
+
+# Paths
+DATA_PATH = os.path.join("python_ml_server", "data", "test.txt")
+MODEL_PATH = os.path.join("python_ml_server", "model", "model.keras")
+TOKENIZER_PATH = os.path.join("python_ml_server", "model", "tokenizer.pkl")
+LABEL_ENCODER_PATH = os.path.join("python_ml_server", "model", "label_encoder.pkl")
+
+# Parameters
+MAX_LEN = 100
+
+# Accuracy cost of storing the bundle weights as fp16 / bf16 (export_bundle.py --dtype).
+# The native engine widens every weight to float32 before use, so rounding the stored
+# weights here reproduces its results up to float32 summation order.
+print("Loading model, tokenizer and dataset...")
+model = tf.keras.models.load_model(MODEL_PATH)
+with open(TOKENIZER_PATH, "rb") as f:
+    tokenizer = pickle.load(f)
+with open(LABEL_ENCODER_PATH, "rb") as f:
+    label_encoder = pickle.load(f)
+data = pd.read_csv(DATA_PATH, sep=";", names=["text", "emotion"])
+labels = label_encoder.transform(data["emotion"])
+inputs = pad_sequences(tokenizer.texts_to_sequences(data["text"]), maxlen=MAX_LEN, padding="post")
+
+baseline = None
+print(f"\n{'weights':<8}{'accuracy':>10}{'delta':>9}{'agrees w/ fp32':>16}{'max |dp|':>10}{'seconds':>9}")
+for dtype in WEIGHT_DTYPES:
+    variant = model if dtype == "fp32" else with_weight_dtype(model, dtype)
+    start = time.perf_counter()
+    probs = variant.predict(inputs, verbose=0)
+    seconds = time.perf_counter() - start
+    if baseline is None:
+        baseline = probs
+    preds, base_preds = np.argmax(probs, axis=1), np.argmax(baseline, axis=1)
+    accuracy = (preds == labels).mean()
+    delta = accuracy - (base_preds == labels).mean()
+    print(f"{dtype:<8}{accuracy:>10.4f}{delta:>+9.4f}{(preds == base_preds).mean():>16.4f}"
+          f"{np.abs(probs - baseline).max():>10.2e}{seconds:>9.2f}")
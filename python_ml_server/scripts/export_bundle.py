@@ -0,0 +1,48 @@
+import argparse
+import os
+import time
+import numpy as np
+import tensorflow as tf
+from model_variants import WEIGHT_DTYPES, narrowed_weight, publish_version, write_bundle
+
+# Paths
+MODEL_DIR = os.path.join("python_ml_server", "model")
+MODEL_PATH = os.path.join("python_ml_server", "model", "model.keras")
+BUNDLE_PATH = os.path.join("python_ml_server", "model", "model.bundle")  # loaded by NativeEngine
+
+parser = argparse.ArgumentParser(description="Export the model weights for the C++ native engine")
+parser.add_argument("--dtype", choices=WEIGHT_DTYPES, default="fp32",
+                    help="storage for the embedding and LSTM kernels (biases and Dense stay fp32); "
+                         "check the accuracy cost with evaluate_precision.py")
+args = parser.parse_args()
+
+# Load trained model
+print("Loading Keras model...")
+model = tf.keras.models.load_model(MODEL_PATH)
+embedding, bilstm1, bilstm2, dense1, dense2 = [
+    layer for layer in model.layers if not isinstance(layer, tf.keras.layers.Dropout)]
+
+
+def stored(layer, array):
+    return args.dtype if narrowed_weight(layer, array) else "fp32"
+
+
+# Keras LSTM weights are [kernel, recurrent_kernel, bias] with gates ordered i, f, c, o
+weights = embedding.get_weights()[0]
+tensors = [("embedding", weights, stored(embedding, weights))]
+for prefix, layer in [("lstm1", bilstm1), ("lstm2", bilstm2)]:
+    for direction, sublayer in [("fw", layer.forward_layer), ("bw", layer.backward_layer)]:
+        kernel, recurrent, bias = sublayer.get_weights()
+        tensors += [(f"{prefix}_{direction}_kernel", kernel, stored(layer, kernel)),
+                    (f"{prefix}_{direction}_recurrent", recurrent, stored(layer, recurrent)),
+                    (f"{prefix}_{direction}_bias", bias, "fp32")]
+for prefix, layer in [("dense1", dense1), ("dense2", dense2)]:
+    kernel, bias = layer.get_weights()
+    tensors += [(f"{prefix}_kernel", kernel, "fp32"), (f"{prefix}_bias", bias, "fp32")]
+
+write_bundle(BUNDLE_PATH, tensors)
+print(f"Model bundle exported at {BUNDLE_PATH} ({args.dtype}, {os.path.getsize(BUNDLE_PATH) / 1e6:.1f} MB)")
+
+# Bump VERSION so running C++ clients hot-reload onto the bundle
+version = time.strftime("%Y%m%d-%H%M%S") + "-bundle"
+publish_version(MODEL_DIR, version, exported="model.bundle")
@@ -0,0 +1,72 @@
+import argparse
+import os
+import time
+import tensorflow as tf
+from tensorflow.core.protobuf import config_pb2, meta_graph_pb2
+from tensorflow.python.framework.convert_to_constants import convert_variables_to_constants_v2
+from tensorflow.python.grappler import tf_optimizer
+from model_variants import clone_for_inference, publish_version
+
+# Paths
+MODEL_DIR = os.path.join("python_ml_server", "model")
+MODEL_PATH = os.path.join("python_ml_server", "model", "model.keras")
+FROZEN_PATH = os.path.join("python_ml_server", "model", "frozen_model.pb")  # loaded by TFEngine::load_frozen
+
+# Parameters
+MAX_LEN = 100
+
+parser = argparse.ArgumentParser(description="Export a frozen inference graph for the C++ client")
+parser.add_argument("--dynamic-length", action="store_true",
+                    help="accept any sequence length so the client can run length buckets")
+parser.add_argument("--masked", action="store_true",
+                    help="mask padding inside the LSTMs (implies --dynamic-length)")
+args = parser.parse_args()
+dynamic_length = args.dynamic_length or args.masked
+
+# Load trained model
+print("Loading Keras model...")
+model = tf.keras.models.load_model(MODEL_PATH)
+if dynamic_length:
+    model = clone_for_inference(model, mask_zero=args.masked)
+
+# Trace an inference-only function with a float [batch, length] input, like the C++ client feeds
+@tf.function(input_signature=[tf.TensorSpec([None, None if dynamic_length else MAX_LEN], tf.float32, name="input")])
+def serve(x):
+    return model(x, training=False)
+
+# Freeze: inline every variable as a constant so no checkpoint restore is needed at load time
+print("Freezing variables into constants...")
+frozen_func = convert_variables_to_constants_v2(serve.get_concrete_function())
+graph_def = frozen_func.graph.as_graph_def()
+
+# Run Grappler offline: constant folding, arithmetic simplification, pruning of unused nodes
+print("Optimizing graph for inference...")
+meta_graph = tf.compat.v1.train.export_meta_graph(graph_def=graph_def, graph=frozen_func.graph)
+fetches = meta_graph_pb2.CollectionDef()
+for output in frozen_func.outputs:
+    fetches.node_list.value.append(output.name)
+meta_graph.collection_def["train_op"].CopyFrom(fetches)
+
+config = config_pb2.ConfigProto()
+rewriter = config.graph_options.rewrite_options
+rewriter.optimizers.extend(["constfold", "arithmetic", "dependency", "function", "pruning", "remap"])
+rewriter.meta_optimizer_iterations = 2
+optimized = tf_optimizer.OptimizeGraph(config, meta_graph)
+print(f"Graph nodes: {len(graph_def.node)} frozen, {len(optimized.node)} after optimization")
+
+# TFEngine::load_frozen fetches "output:0"; the fetched node has no consumers, so renaming it is safe
+fetch_name = frozen_func.outputs[0].name.split(":")[0]
+fetch_nodes = [node for node in optimized.node if node.name == fetch_name]
+assert len(frozen_func.outputs) == 1 and len(fetch_nodes) == 1, "expected exactly one output node"
+assert not any(node.name == "output" for node in optimized.node), "a node is already named output"
+fetch_nodes[0].name = "output"
+
+# Write atomically so a running client never imports a half-written file
+with open(FROZEN_PATH + ".tmp", "wb") as f:
+    f.write(optimized.SerializeToString())
+os.replace(FROZEN_PATH + ".tmp", FROZEN_PATH)
+print(f"Frozen graph exported at {FROZEN_PATH} ({os.path.getsize(FROZEN_PATH) / 1e6:.1f} MB)")
+
+# Bump VERSION so running C++ clients hot-reload onto the frozen graph
+version = time.strftime("%Y%m%d-%H%M%S") + ("-masked" if args.masked else "-dynamic" if dynamic_length else "-frozen")
+publish_version(MODEL_DIR, version, exported="frozen_model.pb")
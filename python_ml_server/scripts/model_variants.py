@@ -0,0 +1,130 @@
+import os
+import struct
+import numpy as np
+import tensorflow as tf
+
+# Length buckets used by the C++ client's bucketed execution mode
+LENGTH_BUCKETS = [16, 32, 64, 100]
+
+# Weight storage precisions of the native engine, with their model.bundle dtype codes
+WEIGHT_DTYPES = {"fp32": 0, "fp16": 1, "bf16": 2}
+
+
+def clone_for_inference(model, mask_zero=False):
+    """Rebuild the trained model with a dynamic time dimension, optionally masking padding.
+
+    With mask_zero=True the LSTMs skip padded (index 0) steps entirely, which makes the
+    result independent of how much padding follows the text.
+    """
+    config = model.get_config()
+    for layer in config["layers"]:
+        if layer["class_name"] == "InputLayer":
+            layer["config"]["batch_shape"] = [None, None]
+        if layer["class_name"] == "Embedding":
+            layer["config"]["mask_zero"] = mask_zero
+    clone = tf.keras.Sequential.from_config(config)
+    clone.build((None, None))
+    clone.set_weights(model.get_weights())
+    return clone
+
+
+def bucket_for(length, buckets=LENGTH_BUCKETS):
+    """Smallest bucket that fits length (the last bucket is the padded max length)."""
+    for bucket in buckets:
+        if bucket >= length:
+            return bucket
+    return buckets[-1]
+
+
+def to_bf16_bits(array):
+    """Round float32 values to bfloat16 (nearest even) and return the raw uint16 bits."""
+    bits = np.ascontiguousarray(array, dtype=np.float32).view(np.uint32).astype(np.uint64)
+    return ((bits + 0x7FFF + ((bits >> 16) & 1)) >> 16).astype(np.uint16)
+
+
+def round_to_dtype(array, dtype):
+    """The float32 values the native engine computes with after storing array as dtype."""
+    array = np.asarray(array, dtype=np.float32)
+    if dtype == "fp16":
+        return array.astype(np.float16).astype(np.float32)
+    if dtype == "bf16":
+        return (to_bf16_bits(array).astype(np.uint32) << 16).view(np.float32).reshape(array.shape)
+    return array
+
+
+def narrowed_weight(layer, weight):
+    """Whether export_bundle.py stores this weight in 16 bits: the embedding and LSTM
+    kernels do, biases and the small Dense layers stay float32."""
+    return weight.ndim == 2 and isinstance(layer, (tf.keras.layers.Embedding, tf.keras.layers.Bidirectional))
+
+
+def with_weight_dtype(model, dtype):
+    """Copy of model with weights rounded the way a dtype bundle stores them."""
+    clone = tf.keras.models.clone_model(model)
+    clone.build(model.input_shape)
+    for source, target in zip(model.layers, clone.layers):
+        target.set_weights([round_to_dtype(w, dtype) if narrowed_weight(source, w) else w
+                            for w in source.get_weights()])
+    return clone
+
+
+def encode(array, dtype):
+    """Raw little-endian bytes of array stored as dtype."""
+    if dtype == "fp16":
+        return np.ascontiguousarray(array, dtype="<f2").tobytes()
+    if dtype == "bf16":
+        return to_bf16_bits(array).astype("<u2").tobytes()
+    return np.ascontiguousarray(array, dtype="<f4").tobytes()
+
+
+def write_bundle(path, tensors):
+    """Write (name, array, dtype) tensors in the layout ModelBundle.cpp reads (see ModelBundle.h)."""
+    with open(path + ".tmp", "wb") as f:
+        f.write(b"EMOB")
+        f.write(struct.pack("<II", 1, len(tensors)))
+        for name, array, dtype in tensors:
+            encoded = name.encode("utf8")
+            f.write(struct.pack("<I", len(encoded)))
+            f.write(encoded)
+            f.write(struct.pack("<I", array.ndim))
+            f.write(struct.pack(f"<{array.ndim}I", *array.shape))
+            f.write(struct.pack("<I", WEIGHT_DTYPES[dtype]))
+            f.write(encode(array, dtype))
+    os.replace(path + ".tmp", path)
+
+
+# Exported from model.keras by export_frozen.py and export_bundle.py. Each has a stamp,
+# <artifact>.version, with the VERSION it was exported for; the C++ client refuses an
+# artifact whose stamp differs from VERSION, so a retrained model never runs stale weights.
+DERIVED_ARTIFACTS = ["frozen_model.pb", "model.bundle"]
+
+
+def write_text_atomic(path, text):
+    with open(path + ".tmp", "w") as f:
+        f.write(text)
+    os.replace(path + ".tmp", path)
+
+
+def remove_derived_artifacts(model_dir):
+    """Delete the exports of a previous model.keras; train.py calls this before saving a new one."""
+    for name in DERIVED_ARTIFACTS:
+        for path in [os.path.join(model_dir, name), os.path.join(model_dir, name + ".version")]:
+            if os.path.exists(path):
+                os.remove(path)
+                print(f"Removed stale {path}")
+
+
+def publish_version(model_dir, version, exported=None):
+    """Stamp the artifact just exported (a DERIVED_ARTIFACTS name) with version, then write VERSION.
+
+    The other artifacts stamped with the previous VERSION come from the same model.keras and
+    carry over to the new one. VERSION is written last: running C++ clients reload once it appears.
+    """
+    version_path = os.path.join(model_dir, "VERSION")
+    previous = open(version_path).read().strip() if os.path.exists(version_path) else None
+    for name in DERIVED_ARTIFACTS:
+        stamp_path = os.path.join(model_dir, name + ".version")
+        stamp = open(stamp_path).read().strip() if os.path.exists(stamp_path) else None
+        if name == exported or (previous is not None and stamp == previous):
+            write_text_atomic(stamp_path, version + "\n")
+    write_text_atomic(version_path, version + "\n")
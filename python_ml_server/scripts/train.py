@@ -11,8 +11,11 @@ from sklearn.model_selection import train_test_split
 from keras.callbacks import EarlyStopping
 from sklearn.metrics import classification_report
 import pickle
+import time
+from model_variants import publish_version, remove_derived_artifacts, write_bundle
 
 # Paths
+MODEL_DIR = os.path.join("python_ml_server", "model")
 DATA_PATH = os.path.join("python_ml_server", "data", "test.txt")
 GLOVE_PATH = os.path.join("python_ml_server", "data", "glove.6B.300d.txt")
 MODEL_PATH = os.path.join("python_ml_server", "model", "model.keras")  # updated to new Keras format
@@ -20,6 +23,10 @@ TOKENIZER_PATH = os.path.join("python_ml_server", "model", "tokenizer.pkl")
 LABEL_ENCODER_PATH = os.path.join("python_ml_server", "model", "label_encoder.pkl")
 TFLITE_MODEL_PATH = os.path.join("python_ml_server", "model", "model.tflite")  # path for tflite model
 SAVED_MODEL_PATH = os.path.join("python_ml_server", "model", "saved_model")    # path for TF SavedModel
+WORD_INDEX_PATH = os.path.join("python_ml_server", "model", "word_index.txt")  # vocabulary for C++ client
+LABELS_PATH = os.path.join("python_ml_server", "model", "labels.txt")          # labels for C++ client
+CANARY_PATH = os.path.join("python_ml_server", "model", "canary.txt")          # hot-reload validation set
+CASCADE_PATH = os.path.join("python_ml_server", "model", "cascade.bundle")     # C++ cascade fast path
 
 # Parameters
 MAX_LEN = 100
@@ -41,8 +48,8 @@ padded = pad_sequences(sequences, maxlen=MAX_LEN, padding="post")
 label_encoder = LabelEncoder()
 labels = label_encoder.fit_transform(data["emotion"])
 
-# Train-test split
-X_train, X_val, y_train, y_val = train_test_split(padded, labels, test_size=0.2, random_state=42)
+# Train-test split (the rows of data come along for the canary set, drawn from validation only)
+X_train, X_val, y_train, y_val, _, val_data = train_test_split(padded, labels, data, test_size=0.2, random_state=42)
 
 # Load GloVe embeddings
 def load_glove_embeddings(glove_file_path, embedding_dim, word_index):
@@ -97,8 +104,10 @@ y_pred = np.argmax(y_pred_probs, axis=1)
 print("Classification Report:")
 print(classification_report(y_val, y_pred, target_names=label_encoder.classes_))
 
-# Save model and tokenizer
+# Save model and tokenizer. Exports of the previous model.keras go first: the C++ client
+# prefers them, and they would otherwise be served as part of the new version.
 print("Saving model and tokenizer...")
+remove_derived_artifacts(MODEL_DIR)
 model.save(MODEL_PATH)
 with open(TOKENIZER_PATH, "wb") as f:
     pickle.dump(tokenizer, f)
@@ -118,3 +127,65 @@ print(f"Model exported to TensorFlow Lite format at {TFLITE_MODEL_PATH}")
 print("Exporting model as TensorFlow SavedModel for C/C++ API...")
 model.export(SAVED_MODEL_PATH)
 print(f"Model exported as TensorFlow SavedModel at {SAVED_MODEL_PATH}")
+
+# Export vocabulary, labels and a canary set for the C++ client
+print("Exporting vocabulary, labels and canary set for C/C++ client...")
+with open(WORD_INDEX_PATH, "w", encoding="utf8") as f:
+    for word, idx in tokenizer.word_index.items():
+        f.write(f"{word} {idx}\n")
+with open(LABELS_PATH, "w", encoding="utf8") as f:
+    for label in label_encoder.classes_:
+        f.write(f"{label}\n")
+# Held-out rows only: a canary the model was trained on cannot catch a worse model
+canary = val_data.sample(n=min(200, len(val_data)), random_state=0)
+with open(CANARY_PATH, "w", encoding="utf8") as f:
+    for text, emotion in zip(canary["text"], canary["emotion"]):
+        f.write(f"{text};{emotion}\n")
+
+# Cascade fast path: a tiny classifier over the mean GloVe vector of each text's tokens.
+# The C++ client answers with it directly when it is confident and escalates the rest
+# to the BiLSTM.
+print("Training cascade fast-path classifier...")
+def mean_embeddings(rows):
+    features = np.zeros((len(rows), EMBEDDING_DIM), dtype="float32")
+    for n, row in enumerate(rows):
+        ids = row[row > 0]
+        if len(ids):
+            features[n] = embedding_matrix[ids].mean(axis=0)
+    return features
+
+bag_train, bag_val = mean_embeddings(X_train), mean_embeddings(X_val)
+fast_model = Sequential()
+fast_model.add(tf.keras.Input(shape=(EMBEDDING_DIM,)))
+fast_model.add(Dense(64, activation="relu"))
+fast_model.add(Dense(len(label_encoder.classes_), activation="softmax"))
+fast_model.compile(loss="sparse_categorical_crossentropy", optimizer="adam", metrics=["accuracy"])
+fast_model.fit(bag_train, y_train, validation_data=(bag_val, y_val), epochs=50, batch_size=64,
+               callbacks=[EarlyStopping(monitor="val_loss", patience=3, restore_best_weights=True)], verbose=0)
+
+# Calibrate: the lowest confidence at which the fast path is at least as accurate as
+# the BiLSTM on the validation inputs it would answer
+fast_probs = fast_model.predict(bag_val, verbose=0)
+fast_conf, fast_pred = fast_probs.max(axis=1), fast_probs.argmax(axis=1)
+threshold = 1.0
+for candidate in np.arange(0.5, 1.0, 0.01):
+    accepted = fast_conf >= candidate
+    if accepted.any() and (fast_pred[accepted] == y_val[accepted]).mean() >= (y_pred[accepted] == y_val[accepted]).mean():
+        threshold = float(candidate)
+        break
+accepted = fast_conf >= threshold
+cascade_pred = np.where(accepted, fast_pred, y_pred)
+print(f"Cascade threshold {threshold:.2f}: {100 * (1 - accepted.mean()):.1f}% escalated, "
+      f"accuracy {(cascade_pred == y_val).mean():.4f} (BiLSTM alone {(y_pred == y_val).mean():.4f})")
+
+(k1, b1), (k2, b2) = [layer.get_weights() for layer in fast_model.layers]
+write_bundle(CASCADE_PATH, [("embedding", embedding_matrix.astype("float32"), "fp32"),
+                            ("dense1_kernel", k1, "fp32"), ("dense1_bias", b1, "fp32"),
+                            ("dense2_kernel", k2, "fp32"), ("dense2_bias", b2, "fp32"),
+                            ("threshold", np.array([threshold], dtype="float32"), "fp32")])
+print(f"Cascade exported at {CASCADE_PATH}")
+
+# Write VERSION last and atomically: running C++ clients reload once it appears
+version = time.strftime("%Y%m%d-%H%M%S")
+publish_version(MODEL_DIR, version)
+print(f"Model version {version} is complete")